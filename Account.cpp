@@ -9,38 +9,222 @@
  */
 
 #include "Account.h"
+#include "ReportWriter.h"
+#include "AccountArena.h"
 #include <cctype>
 #include <algorithm>
 
 // Constructor to initialize account details
-Account::Account(string number, string description, Account* parent)
-    : number(move(number)), description(move(description)), balance(0), parent(parent) {}
+Account::Account(AccountArena* arena, uint32_t id, string number)
+    : number(move(number)), id(id), arena(arena), deletedCount(0) {}
 
-// Adds a child account
-void Account::addChild(shared_ptr<Account> child) {
+// Reads the account's own balance from the balance column
+Money Account::balance() const {
+    return Money::fromMinor(arena->columns.balances[id]);
+}
+
+// Reads the subtree balance from the roll-up column
+Money Account::rollupBalance() const {
+    return Money::fromMinor(arena->columns.rollups[id]);
+}
+
+// Resolves the parent id column to an account
+Account* Account::parent() const {
+    uint32_t parentId = arena->columns.parentIds[id];
+    return parentId == AccountColumns::NO_PARENT ? nullptr : arena->at(parentId);
+}
+
+// Returns a view of the description in the arena's text pool. The view is
+// invalidated when another account is added.
+string_view Account::description() const {
+    const AccountColumns& columns = arena->columns;
+    return string_view(columns.descriptionText).substr(columns.descriptionOffsets[id], columns.descriptionLengths[id]);
+}
+
+// Makes this account a root
+void Account::clearParent() {
+    arena->columns.parentIds.mutate(id) = AccountColumns::NO_PARENT;
+}
+
+// Links a child account under this one
+void Account::addChild(Account* child) {
     if (child) {
-        children.push_back(move(child));
+        arena->columns.parentIds.mutate(child->id) = id;
+        insertSorted(children, child);
     } else {
         cerr << "Error: Attempted to add a null child to account " << number << endl;
     }
 }
 
-// Adds a transaction to the account
-void Account::addTransaction(const Transaction& transaction) {
+// Inserts account into a list kept in ascending number order. Siblings are
+// never prefixes of each other, so this is also hierarchy (trie) order.
+// Ordered walks append at the end, which costs one comparison.
+void Account::insertSorted(vector<Account*>& accounts, Account* account) {
+    if (accounts.empty() || accounts.back()->number < account->number) {
+        accounts.push_back(account);
+        return;
+    }
+    auto position = lower_bound(accounts.begin(), accounts.end(), account, [](const Account* a, const Account* b) {
+        return a->number < b->number;
+    });
+    accounts.insert(position, account);
+}
+
+// Stores a record under the next sequence number
+uint32_t Account::appendRecord(Transaction transaction) {
+    uint32_t sequence = static_cast<uint32_t>(slotBySequence.size());
+    if (sequence > Transaction::MAX_SEQUENCE) {
+        throw overflow_error("Error: Account " + number + " has too many transactions.");
+    }
+
+    transaction.setSequence(sequence);
+    slotBySequence.push_back(static_cast<uint32_t>(transactions.size()));
     transactions.push_back(transaction);
-    balance += (transaction.debitCredit == 'D' ? transaction.amount : -transaction.amount);
+    if (timeIndex && !timeIndex->append(transaction)) {
+        timeIndex.reset();  // Older than the newest posting: rebuild on the next query
+    }
+    return sequence;
 }
 
-// Deletes a transaction by index
-void Account::deleteTransaction(int index) {
-    if (index >= 0 && index < transactions.size()) {
-        auto transaction = transactions[index];
-        balance -= (transaction.debitCredit == 'D' ? transaction.amount : -transaction.amount);
-        transactions.erase(transactions.begin() + index);
-        cout << "Transaction successfully deleted.\n"; // Confirmation message
-    } else {
-        cerr << "Error: Invalid transaction index for account " << number << ". Index out of range.\n";
+// Reserves room in both the records and the sequence index. Capacity at
+// least doubles when it grows, so many small batches stay amortized O(1)
+// per posting instead of reallocating on every batch.
+void Account::reserveTransactions(size_t additional) {
+    if (transactions.size() + additional > transactions.capacity()) {
+        transactions.reserve(max(transactions.size() + additional, 2 * transactions.capacity()));
     }
+    if (slotBySequence.size() + additional > slotBySequence.capacity()) {
+        slotBySequence.reserve(max(slotBySequence.size() + additional, 2 * slotBySequence.capacity()));
+    }
+}
+
+// Adds a transaction to the account. The new totals are worked out before
+// the record is stored, so a posting that does not fit throws with the
+// account unchanged.
+uint64_t Account::addTransaction(const Transaction& transaction) {
+    Money amount = transaction.signedAmount();
+    if (!fitsChange(amount, transaction.amount, transaction.isCredit())) {
+        throw overflow_error("Error: Amount is out of range.");
+    }
+    Money::Rep& own = arena->columns.balances.mutate(id);
+    Money::Rep& side = (transaction.isCredit() ? arena->columns.creditTotals : arena->columns.debitTotals).mutate(id);
+    Money newOwn = Money::fromMinor(own) + amount;
+    Money newSide = Money::fromMinor(side) + transaction.amount;
+
+    uint32_t sequence = appendRecord(transaction);
+    own = newOwn.minorUnits();
+    side = newSide.minorUnits();
+    propagateRollup(amount);
+    return (static_cast<uint64_t>(id) << 32) | sequence;
+}
+
+// Walks the parent column so every ancestor's total reflects the change.
+// Only the parent and roll-up columns are touched, not the Account objects.
+void Account::propagateRollup(Money amount) {
+    AccountColumns& columns = arena->columns;
+    for (uint32_t current = id; current != AccountColumns::NO_PARENT; current = columns.parentIds[current]) {
+        Money::Rep& rollup = columns.rollups.mutate(current);
+        rollup = (Money::fromMinor(rollup) + amount).minorUnits();
+    }
+}
+
+// Checks the own balance, the side total and the roll-up of this account and
+// every ancestor, so a change that would overflow is refused before anything
+// is written
+bool Account::fitsChange(Money signedAmount, Money sideAmount, bool credit) const {
+    const AccountColumns& columns = arena->columns;
+    const Money side = Money::fromMinor((credit ? columns.creditTotals : columns.debitTotals)[id]);
+    if (!balance().canAdd(signedAmount) || !side.canAdd(sideAmount)) {
+        return false;
+    }
+    for (uint32_t current = id; current != AccountColumns::NO_PARENT; current = columns.parentIds[current]) {
+        if (!Money::fromMinor(columns.rollups[current]).canAdd(signedAmount)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Returns the time index, building it if no query has since the last
+// out-of-order posting
+const PostingTimeIndex& Account::timeline() const {
+    if (!timeIndex) {
+        timeIndex = make_unique<PostingTimeIndex>();
+        timeIndex->build(transactions, slotBySequence.size());
+    }
+    return *timeIndex;
+}
+
+// Own balance counting only postings up to time
+bool Account::balanceAsOf(int64_t time, Money& balance) const {
+    return timeline().balanceAsOf(time, balance);
+}
+
+// Net amount posted between two times, both inclusive
+bool Account::movementBetween(int64_t from, int64_t to, Money& movement) const {
+    return timeline().movementBetween(from, to, movement);
+}
+
+// Returns the live transaction with this sequence number
+const Transaction* Account::findTransaction(uint32_t sequence) const {
+    if (sequence >= slotBySequence.size() || slotBySequence[sequence] == NO_SLOT) {
+        return nullptr;
+    }
+    return &transactions[slotBySequence[sequence]];
+}
+
+// Deletes a transaction by sequence number. The record is only marked, so
+// no later posting moves and every other sequence number stays valid.
+bool Account::deleteTransaction(uint32_t sequence) {
+    if (findTransaction(sequence) == nullptr) {
+        cerr << "Error: Invalid transaction ID for account " << number << ". No such transaction.\n";
+        return false;
+    }
+
+    Transaction& transaction = transactions[slotBySequence[sequence]];
+    if (!fitsChange(-transaction.signedAmount(), -transaction.amount, transaction.isCredit())) {
+        cerr << "Error: Amount is out of range.\n";
+        return false;
+    }
+    transaction.flags |= Transaction::DELETED;
+    slotBySequence[sequence] = NO_SLOT;
+    ++deletedCount;
+    if (timeIndex) {
+        timeIndex->remove(transaction);
+    }
+
+    Money amount = transaction.signedAmount();
+    Money::Rep& own = arena->columns.balances.mutate(id);
+    own = (Money::fromMinor(own) - amount).minorUnits();
+    Money::Rep& side = (transaction.isCredit() ? arena->columns.creditTotals : arena->columns.debitTotals).mutate(id);
+    side = (Money::fromMinor(side) - transaction.amount).minorUnits();
+    propagateRollup(-amount);
+
+    // Amortized O(1): compaction runs only after as many deletions as survivors
+    if (deletedCount >= 64 && deletedCount * 2 >= transactions.size()) {
+        compactTransactions();
+    }
+
+    return true;
+}
+
+// Removes tombstones in place, preserving order, and updates the index
+void Account::compactTransactions() {
+    size_t kept = 0;
+    for (size_t slot = 0; slot < transactions.size(); ++slot) {
+        if (!transactions[slot].isDeleted()) {
+            transactions[kept] = transactions[slot];
+            slotBySequence[transactions[kept].sequence()] = static_cast<uint32_t>(kept);
+            ++kept;
+        }
+    }
+    transactions.resize(kept);
+    deletedCount = 0;
+}
+
+// True if this account's number is a proper prefix of otherNumber
+bool Account::isAncestorOf(const string& otherNumber) const {
+    return otherNumber.size() > number.size() && otherNumber.compare(0, number.size(), number) == 0;
 }
 
 // Validates the account number to ensure it contains only numeric characters
@@ -61,44 +245,36 @@ bool Account::createAccount(const string& number, const string& description) {
     }
 
     this->number = number;
-    this->description = description;
+    arena->columns.numberKeys[id] = AccountArena::numberKey(number);
+    arena->setDescription(id, description);
     return true;
 }
 
-// Prints account details, including the index of each transaction
+// Prints account details, including the ID of each transaction
 void Account::printDetails(ostream& os) const {
     // Print account number and the first 10 characters of the description
     os << "Account Number: " << number << "\n"
-       << "Description: " << description.substr(0, 10) << "\n"  // Only first 10 characters
-       << "Balance: $" << balance << "\n"
+       << "Description: " << description().substr(0, 10) << "\n"  // Only first 10 characters
+       << "Balance: $" << balance() << "\n"
+       << "Total Balance (with sub-accounts): $" << rollupBalance() << "\n"
        << "Transactions:\n";
 
-    // Print each transaction with its index
-    for (int i = 0; i < transactions.size(); ++i) {
-        const auto& transaction = transactions[i];
-        os << "Index " << i << ": " << transaction << "\n";  // Print index with the transaction
+    // Print each live transaction with its ID, which stays valid after deletions
+    for (const auto& transaction : transactions) {
+        if (!transaction.isDeleted()) {
+            os << "ID " << transaction.sequence() << ": Account: " << number << ", " << transaction << "\n";
+        }
     }
 }
 
 
 // Destructor
 Account::~Account() {
-    // No additional cleanup needed as children are managed using shared_ptr
+    // No additional cleanup needed as the ForestTree owns every account
 }
 
 // Prints the account hierarchy recursively
 void Account::printHierarchy(ostream& os, int level) const {
-    os << string(level * 4, ' ') << number << " - " << description
-       << " (Balance: $" << balance << ")\n";
-
-    if (!transactions.empty()) {
-        os << string((level + 1) * 4, ' ') << "Transactions:\n";
-        for (const auto& transaction : transactions) {
-            os << string((level + 2) * 4, ' ') << transaction << "\n";
-        }
-    }
-
-    for (const auto& child : children) {
-        child->printHierarchy(os, level + 1);
-    }
+    ReportWriter writer(os);
+    writer.writeHierarchy(this, level);
 }
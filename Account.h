@@ -10,21 +10,58 @@
  *
  * Fields:
  *  - string number: The unique account number.
- *  - string description: A brief description of the account.
- *  - double balance: The current balance of the account.
- *  - Account* parent: Pointer to the parent account, if any.
- *  - vector<shared_ptr<Account>> children: Vector of child accounts.
- *  - vector<Transaction> transactions: List of transactions for the account.
+ *  - uint32_t id: Dense index assigned by the ForestTree; stored in each
+ *    Transaction instead of a copy of the number.
+ *  - AccountArena* arena: The arena that owns this account. Hot fields
+ *    (balance, roll-up, parent, description) live in its columns at [id].
+ *  - vector<Account*> children: Child accounts in ascending number order.
+ *    Accounts are owned by the ForestTree, so these are non-owning links.
+ *  - vector<Transaction> transactions: Transactions in the order they were
+ *    appended. Deleted ones remain as tombstones until compaction.
+ *  - vector<uint32_t> slotBySequence: Maps each posting's sequence number to
+ *    its current slot in transactions (NO_SLOT once deleted).
+ *  - uint32_t deletedCount: Tombstones currently held in transactions.
+ *  - unique_ptr<PostingTimeIndex> timeIndex: The postings in time order with
+ *    prefix sums. Built by the first as-of query, then kept current by
+ *    appends and deletions; an out-of-order posting drops it until the next
+ *    query rebuilds it.
  *
  * Functions:
- *  - Account(string number, string description, Account* parent = nullptr):
- *      Constructor to initialize account details and its parent.
- *  - void addChild(shared_ptr<Account> child):
- *      Adds a child account to the current account.
- *  - void addTransaction(const Transaction& transaction):
- *      Adds a transaction to the account and updates its balance.
- *  - void deleteTransaction(int index):
- *      Removes a transaction by index and updates balance.
+ *  - Account(AccountArena* arena, uint32_t id, string number):
+ *      Constructor; called by AccountArena::create.
+ *  - Money balance() const / Money rollupBalance() const:
+ *      The account's own balance, and its balance including descendants,
+ *      kept current on every transaction.
+ *  - Account* parent() const / string_view description() const:
+ *      Views onto the parent and description columns.
+ *  - void addChild(Account* child):
+ *      Links a child account under the current account, keeping children
+ *      sorted so an in-order walk needs no sorting.
+ *  - static void insertSorted(vector<Account*>& accounts, Account* account):
+ *      Inserts into a list ordered by account number.
+ *  - bool isAncestorOf(const string& otherNumber) const:
+ *      True if this account's number is a proper prefix of otherNumber.
+ *  - uint32_t appendRecord(Transaction transaction):
+ *      Assigns the next sequence number and stores the record; balances are
+ *      left to the caller. Returns the sequence number.
+ *  - uint64_t addTransaction(const Transaction& transaction):
+ *      Appends a transaction, updates the balance and the roll-up balance of
+ *      this account and every ancestor in O(depth). Returns its posting ID.
+ *      Throws overflow_error, recording nothing, if a total would overflow.
+ *  - bool deleteTransaction(uint32_t sequence):
+ *      Deletes a transaction by its sequence number in O(1 + depth): the
+ *      record becomes a tombstone and its amount is reversed up the chain.
+ *      Tombstones are compacted away once they make up half the vector.
+ *      Refused, with nothing changed, if a balance would leave Money's range.
+ *  - bool fitsChange(Money signedAmount, Money sideAmount, bool credit) const:
+ *      True if the balance, the debit or credit total and every roll-up up
+ *      the chain stay in range after the change; checked before posting.
+ *  - bool balanceAsOf(int64_t time, Money& balance) const:
+ *      The account's own balance counting postings at or before time, in
+ *      O(log n) once the time index is built; false if it is out of range.
+ *  - bool movementBetween(int64_t from, int64_t to, Money& movement) const:
+ *      Net signed amount posted between from and to (both inclusive);
+ *      false if it is out of range.
  *  - void printDetails(ostream& os) const:
  *      Prints the account details, including transactions.
  */
@@ -37,10 +74,15 @@
 #include <memory>
 #include <iostream>
 #include <algorithm>
+#include <cstdint>
+#include <string_view>
 #include "Transaction.h"
+#include "PostingTimeIndex.h"
 
 using namespace std;
 
+class AccountArena;
+
 /**
  * The Account class represents an account with a numeric account number,
  * a description, balance, parent-child relationships, and transactions.
@@ -48,23 +90,71 @@ using namespace std;
 class Account {
 public:
     string number;                         // Unique numeric account number
-    string description;                    // Description of the account
-    double balance;                        // Current balance of the account
-    Account* parent;                       // Pointer to the parent account
-    vector<shared_ptr<Account>> children;  // List of child accounts
-    vector<Transaction> transactions;      // List of transactions
+    uint32_t id;                           // Dense index assigned by the ForestTree
+    AccountArena* arena;                   // Owner of this account's hot columns
+    vector<Account*> children;             // Child accounts in number order (owned by ForestTree)
+    vector<Transaction> transactions;      // Transactions, including tombstones
+    vector<uint32_t> slotBySequence;       // Sequence number -> slot in transactions
+    uint32_t deletedCount;                 // Tombstones in transactions
+    mutable unique_ptr<PostingTimeIndex> timeIndex;  // Built on the first as-of query
+
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;  // slotBySequence entry of a deleted posting
 
     // Constructor
-    Account(string number, string description, Account* parent = nullptr);
+    Account(AccountArena* arena, uint32_t id, string number);
+
+    // Views onto the arena's columns
+    Money balance() const;                 // Balance of this account's own transactions
+    Money rollupBalance() const;           // Balance including all descendants
+    Account* parent() const;               // Parent account, or nullptr for a root
+    string_view description() const;       // Description of the account
+
+    // Detaches the account from its parent (makes it a root)
+    void clearParent();
+
+    // Links a child account under this one, in number order, and sets its parent
+    void addChild(Account* child);
+
+    // Inserts account into a list kept in ascending number order
+    static void insertSorted(vector<Account*>& accounts, Account* account);
+
+    // True if this account's number is a proper prefix of otherNumber
+    bool isAncestorOf(const string& otherNumber) const;
 
-    // Adds a child account
-    void addChild(shared_ptr<Account> child);
+    // Stores a record with the next sequence number, without touching balances
+    uint32_t appendRecord(Transaction transaction);
+
+    // Reserves room for more postings ahead of a batch
+    void reserveTransactions(size_t additional);
 
     // Adds a transaction to the account and updates the balance
-    void addTransaction(const Transaction& transaction);
+    uint64_t addTransaction(const Transaction& transaction);
+
+    // Deletes a transaction by sequence number and updates the balance
+    bool deleteTransaction(uint32_t sequence);
+
+    // True if adding signedAmount to the balance and roll-ups, and sideAmount
+    // to the debit (or credit) total, keeps every one of them in range
+    bool fitsChange(Money signedAmount, Money sideAmount, bool credit) const;
+
+    // Returns the live transaction with this sequence number, or nullptr
+    const Transaction* findTransaction(uint32_t sequence) const;
+
+    // Number of transactions that have not been deleted
+    size_t liveTransactionCount() const { return transactions.size() - deletedCount; }
+
+    // Drops tombstones and re-points slotBySequence at the moved records
+    void compactTransactions();
+
+    // Adds a signed amount to this account's roll-up and every ancestor's
+    void propagateRollup(Money amount);
 
-    // Deletes a transaction by index and updates the balance
-    void deleteTransaction(int index);
+    // Own balance and net movement by posting time; the first query builds
+    // the time index, so these must not run concurrently with each other
+    // or with postings to this account
+    bool balanceAsOf(int64_t time, Money& balance) const;
+    bool movementBetween(int64_t from, int64_t to, Money& movement) const;
+    const PostingTimeIndex& timeline() const;
 
     // Validates that the account number is numeric
     static bool isValidAccountNumber(const string& accountNumber);
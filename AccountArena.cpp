@@ -0,0 +1,178 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: AccountArena.cpp
+ * Purpose: Implements the AccountArena block allocator and its columns.
+ */
+
+#include "AccountArena.h"
+#include "ThreadPool.h"
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <future>
+
+// Reserves room for the given number of accounts in every column
+void AccountColumns::reserve(size_t accounts) {
+    numberKeys.reserve(accounts);
+    parentIds.reserve(accounts);
+    balances.reserve(accounts);
+    rollups.reserve(accounts);
+    debitTotals.reserve(accounts);
+    creditTotals.reserve(accounts);
+    descriptionOffsets.reserve(accounts);
+    descriptionLengths.reserve(accounts);
+}
+
+// Empties every column
+void AccountColumns::clear() {
+    numberKeys.clear();
+    parentIds.clear();
+    balances.clear();
+    rollups.clear();
+    debitTotals.clear();
+    creditTotals.clear();
+    descriptionOffsets.clear();
+    descriptionLengths.clear();
+    descriptionText.clear();
+}
+
+// Copies every page a frozen ledger still shares, so that writes made
+// from several threads never have to copy one
+void AccountColumns::makeWritable() {
+    parentIds.makeWritable();
+    balances.makeWritable();
+    rollups.makeWritable();
+    debitTotals.makeWritable();
+    creditTotals.makeWritable();
+}
+
+// Constructor: Starts with no blocks
+AccountArena::AccountArena() : count(0) {}
+
+// Destructor: Destroys every account and frees the blocks
+AccountArena::~AccountArena() {
+    clear();
+}
+
+// Allocates uninitialized storage for BLOCK_SIZE more accounts
+void AccountArena::addBlock() {
+    blocks.push_back(allocator<Account>().allocate(BLOCK_SIZE));
+}
+
+// Constructs an account in the next free slot and appends its columns
+Account* AccountArena::create(string number, string_view description) {
+    if ((count >> BLOCK_SHIFT) == blocks.size()) {
+        addBlock();
+    }
+
+    columns.numberKeys.push_back(numberKey(number));
+    columns.parentIds.push_back(AccountColumns::NO_PARENT);
+    columns.balances.push_back(0);
+    columns.rollups.push_back(0);
+    columns.debitTotals.push_back(0);
+    columns.creditTotals.push_back(0);
+    columns.descriptionOffsets.push_back(static_cast<uint32_t>(columns.descriptionText.size()));
+    columns.descriptionLengths.push_back(static_cast<uint32_t>(description.size()));
+    columns.descriptionText.append(description);
+
+    Account* account = at(count);
+    new (account) Account(this, count, move(number));
+    ++count;
+    return account;
+}
+
+// Creates a run of accounts. Every column grows to its final size and the
+// description offsets are laid out here; the accounts are then built in
+// independent id ranges, each writing only its own entries, so the ranges
+// can run on several threads.
+uint32_t AccountArena::createRange(span<const pair<string_view, string_view>> accounts, ThreadPool* pool) {
+    uint32_t first = count;
+    size_t total = first + accounts.size();
+    reserve(total);
+
+    columns.numberKeys.resize(total);
+    columns.parentIds.grow(total, AccountColumns::NO_PARENT);
+    columns.balances.grow(total, 0);
+    columns.rollups.grow(total, 0);
+    columns.debitTotals.grow(total, 0);
+    columns.creditTotals.grow(total, 0);
+    columns.descriptionOffsets.resize(total);
+    columns.descriptionLengths.resize(total);
+    size_t textSize = columns.descriptionText.size();
+    for (size_t k = 0; k < accounts.size(); ++k) {
+        columns.descriptionOffsets[first + k] = static_cast<uint32_t>(textSize);
+        columns.descriptionLengths[first + k] = static_cast<uint32_t>(accounts[k].second.size());
+        textSize += accounts[k].second.size();
+    }
+    columns.descriptionText.resize(textSize);
+
+    auto build = [this, accounts, first](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            uint32_t id = static_cast<uint32_t>(first + k);
+            columns.numberKeys[id] = numberKey(accounts[k].first);
+            memcpy(&columns.descriptionText[columns.descriptionOffsets[id]], accounts[k].second.data(),
+                   accounts[k].second.size());
+            new (at(id)) Account(this, id, string(accounts[k].first));
+        }
+    };
+    if (pool == nullptr) {
+        build(0, accounts.size());
+    } else {
+        // A few ranges per thread, in multiples of BLOCK_SIZE accounts
+        size_t step = max<size_t>(BLOCK_SIZE, (accounts.size() / (pool->size() * 4) + BLOCK_MASK) & ~size_t(BLOCK_MASK));
+        vector<future<void>> built;
+        for (size_t begin = 0; begin < accounts.size(); begin += step) {
+            size_t end = min(accounts.size(), begin + step);
+            built.push_back(pool->submit([&build, begin, end] { build(begin, end); }));
+        }
+        for (future<void>& done : built) {
+            done.get();
+        }
+    }
+
+    count = static_cast<uint32_t>(total);
+    return first;
+}
+
+// Appends new description text and points the account at it
+void AccountArena::setDescription(uint32_t id, string_view description) {
+    columns.descriptionOffsets[id] = static_cast<uint32_t>(columns.descriptionText.size());
+    columns.descriptionLengths[id] = static_cast<uint32_t>(description.size());
+    columns.descriptionText.append(description);
+}
+
+// Allocates enough blocks and column space for the given total
+void AccountArena::reserve(size_t accounts) {
+    size_t needed = (accounts + BLOCK_SIZE - 1) >> BLOCK_SHIFT;
+    blocks.reserve(needed);
+    while (blocks.size() < needed) {
+        addBlock();
+    }
+    columns.reserve(accounts);
+}
+
+// Runs each account's destructor (for its strings and vectors), then
+// returns every block to the heap in one sweep
+void AccountArena::clear() {
+    for (uint32_t id = 0; id < count; ++id) {
+        at(id)->~Account();
+    }
+    for (Account* block : blocks) {
+        allocator<Account>().deallocate(block, BLOCK_SIZE);
+    }
+    blocks.clear();
+    columns.clear();
+    count = 0;
+}
+
+// Packs the first 16 digits into nibbles (digit + 1, zero-padded on the
+// right), so comparing keys orders numbers the same way comparing strings does
+uint64_t AccountArena::numberKey(string_view number) {
+    uint64_t key = 0;
+    size_t digits = min<size_t>(number.size(), 16);
+    for (size_t i = 0; i < digits; ++i) {
+        key |= static_cast<uint64_t>(number[i] - '0' + 1) << (60 - 4 * i);
+    }
+    return key;
+}
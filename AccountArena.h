@@ -0,0 +1,128 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: AccountArena.h
+ * Purpose: Defines the AccountArena class, which owns every account of a
+ *          ForestTree. Hot numeric fields live in parallel arrays (a
+ *          structure-of-arrays layout) so that scans touch only the columns
+ *          they need; cold fields live in Account objects allocated in large
+ *          contiguous blocks.
+ *
+ * Fields:
+ *  - vector<Account*> blocks: Storage blocks of BLOCK_SIZE accounts each.
+ *  - uint32_t count: Number of accounts constructed so far.
+ *  - AccountColumns columns: One entry per account id in every column. The
+ *    parent, balance, roll-up and total columns are copy-on-write, so a
+ *    FrozenLedger can keep a period's values while posting continues.
+ *
+ * Functions:
+ *  - Account* create(string number, string_view description):
+ *      Constructs an account in the next free slot, appends its column
+ *      entries and assigns its id.
+ *  - uint32_t createRange(span<const pair<string_view, string_view>> accounts,
+ *                         ThreadPool* pool):
+ *      Creates one account per (number, description) pair with consecutive
+ *      ids, as repeated create() calls would, and returns the first id. The
+ *      columns are sized up front and the accounts are then constructed and
+ *      filled in on pool (or this thread when pool is nullptr).
+ *  - Account* at(uint32_t id) const:
+ *      Returns the account with the given id in O(1).
+ *  - static uint64_t numberKey(string_view number):
+ *      Packs the first 16 digits of a number into an order-preserving key.
+ *  - void clear():
+ *      Destroys every account and releases all blocks at once.
+ *
+ * Accounts never move once created, so raw Account* links (children) stay
+ * valid for the arena's lifetime. Ids are dense: 0, 1, 2, ...
+ */
+
+#ifndef ACCOUNT_ARENA_H
+#define ACCOUNT_ARENA_H
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <span>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include "Account.h"
+#include "Money.h"
+#include "CowColumn.h"
+
+using namespace std;
+
+class ThreadPool;
+
+/**
+ * Struct: AccountColumns
+ * Purpose: Hot per-account data as parallel arrays indexed by account id.
+ */
+struct AccountColumns {
+    static constexpr uint32_t NO_PARENT = UINT32_MAX;
+
+    vector<uint64_t> numberKeys;          // First 16 digits packed as nibbles (digit + 1)
+    CowColumn<uint32_t> parentIds;        // Parent account id, or NO_PARENT for roots
+    CowColumn<Money::Rep> balances;       // Own balance in minor units
+    CowColumn<Money::Rep> rollups;        // Balance including descendants, in minor units
+    CowColumn<Money::Rep> debitTotals;    // Sum of own live debits, in minor units
+    CowColumn<Money::Rep> creditTotals;   // Sum of own live credits, in minor units
+    vector<uint32_t> descriptionOffsets;  // Start of each description in descriptionText
+    vector<uint32_t> descriptionLengths;  // Length of each description
+    string descriptionText;               // Every description back to back
+
+    void reserve(size_t accounts);
+    void clear();
+    void makeWritable();  // Unshares the copy-on-write columns ahead of concurrent writers
+};
+
+/**
+ * Class: AccountArena
+ * Purpose: Block allocator and owner of every Account in a ForestTree, plus
+ *          the columns that hold their hot fields.
+ */
+class AccountArena {
+private:
+    static constexpr uint32_t BLOCK_SHIFT = 10;                // 1024 accounts per block
+    static constexpr uint32_t BLOCK_SIZE = 1u << BLOCK_SHIFT;
+    static constexpr uint32_t BLOCK_MASK = BLOCK_SIZE - 1;
+
+    vector<Account*> blocks;  // Raw storage, constructed up to count
+    uint32_t count;           // Accounts constructed so far
+
+    void addBlock();          // Allocates one more storage block
+
+public:
+    AccountColumns columns;   // Hot fields, indexed by account id
+
+    AccountArena();
+    ~AccountArena();
+
+    AccountArena(const AccountArena&) = delete;
+    AccountArena& operator=(const AccountArena&) = delete;
+
+    Account* create(string number, string_view description);  // Constructs the next account
+    uint32_t createRange(span<const pair<string_view, string_view>> accounts, ThreadPool* pool);  // Bulk create
+
+    Account* at(uint32_t id) const { return blocks[id >> BLOCK_SHIFT] + (id & BLOCK_MASK); }
+    uint32_t size() const { return count; }
+
+    // Replaces an account's description (the old text stays in the pool)
+    void setDescription(uint32_t id, string_view description);
+
+    void reserve(size_t accounts);  // Allocates blocks and columns ahead of a bulk load
+    void clear();                   // Destroys all accounts and frees all blocks
+
+    // Packs up to 16 leading digits so that key order matches string order
+    static uint64_t numberKey(string_view number);
+
+    // Visits every account in id order, one block at a time
+    template <typename Visitor>
+    void forEach(Visitor visit) const {
+        for (uint32_t id = 0; id < count; ++id) {
+            visit(at(id));
+        }
+    }
+};
+
+#endif
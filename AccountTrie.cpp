@@ -0,0 +1,184 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: AccountTrie.cpp
+ * Purpose: Implements the AccountTrie class: exact lookup, slot creation,
+ *          longest-ancestor search and prefix enumeration.
+ */
+
+#include "AccountTrie.h"
+#include <algorithm>
+
+// Constructor: Starts with only the root node
+AccountTrie::AccountTrie() : chunks{}, nodeCount(0), count(0) {
+    newNode();
+}
+
+// Destructor: Frees the node chunks (the accounts belong to the arena)
+AccountTrie::~AccountTrie() {
+    freeChunks();
+}
+
+// Allocates one chunk; value-initialization zeroes every link
+void AccountTrie::addChunk(unsigned chunk) {
+    chunks[chunk] = new Node[size_t(FIRST_CHUNK) << chunk]();
+}
+
+// Frees every allocated chunk
+void AccountTrie::freeChunks() {
+    for (Node*& chunk : chunks) {
+        delete[] chunk;
+        chunk = nullptr;
+    }
+}
+
+// Hands out the next node. It is already zeroed and no reader can reach it
+// until the writer links it, so it needs no initialization here.
+uint32_t AccountTrie::newNode() {
+    uint32_t index = nodeCount++;
+    unsigned chunk = bit_width(uint64_t(index) + FIRST_CHUNK) - 1 - FIRST_CHUNK_SHIFT;
+    if (chunks[chunk] == nullptr) {
+        addChunk(chunk);
+    }
+    return index;
+}
+
+// Hands out the next node of block. An empty block takes the next
+// BLOCK_NODES indices under the mutex and makes sure their chunks exist, so
+// the chunk table only changes under the lock.
+uint32_t AccountTrie::newNode(NodeBlock& block) {
+    if (block.next == block.end) {
+        lock_guard<mutex> lock(blockMutex);
+        block.next = nodeCount;
+        block.end = nodeCount + BLOCK_NODES;
+        nodeCount = block.end;
+        unsigned last = bit_width(uint64_t(block.end - 1) + FIRST_CHUNK) - 1 - FIRST_CHUNK_SHIFT;
+        for (unsigned chunk = 0; chunk <= last; ++chunk) {
+            if (chunks[chunk] == nullptr) {
+                addChunk(chunk);
+            }
+        }
+    }
+    return block.next++;
+}
+
+// Follows prefix from the root; returns 0 if any digit is missing
+uint32_t AccountTrie::findNode(string_view prefix) const {
+    uint32_t current = 0;
+    for (char c : prefix) {
+        unsigned digit = digitOf(c);
+        if (digit == 10) {
+            return 0;
+        }
+        current = node(current).child[digit].load(memory_order_acquire);
+        if (current == 0) {
+            return 0;
+        }
+    }
+    return current;
+}
+
+// Exact lookup of an account number. Never blocks, and may run while the
+// writer inserts: it sees an account either fully published or not at all.
+Account* AccountTrie::find(string_view number) const {
+    if (number.empty()) {
+        return nullptr;
+    }
+    uint32_t found = findNode(number);
+    return found ? node(found).account.load(memory_order_acquire) : nullptr;
+}
+
+// Returns the slot for number, creating any missing nodes along the way.
+// The caller must pass a non-empty, all-digit number. Only one thread may
+// insert at a time.
+atomic<Account*>& AccountTrie::emplace(string_view number) {
+    uint32_t current = 0;
+    for (char c : number) {
+        unsigned digit = digitOf(c);
+        atomic<uint32_t>& link = node(current).child[digit];
+        uint32_t next = link.load(memory_order_relaxed);  // Only this thread stores links
+        if (next == 0) {
+            next = newNode();
+            link.store(next, memory_order_release);  // Publishes the zeroed node
+        }
+        current = next;
+    }
+
+    return claimSlot(current);
+}
+
+// Returns the node for number like emplace, without touching its slot.
+// Several threads may call this at once if each one creates nodes only
+// below nodes that no other thread extends.
+uint32_t AccountTrie::emplacePath(string_view number, NodeBlock& block) {
+    uint32_t current = 0;
+    for (char c : number) {
+        atomic<uint32_t>& link = node(current).child[digitOf(c)];
+        uint32_t next = link.load(memory_order_relaxed);  // This thread owns the subtree
+        if (next == 0) {
+            next = newNode(block);
+            link.store(next, memory_order_release);
+        }
+        current = next;
+    }
+    return current;
+}
+
+// Returns a node's account slot. The caller fills a nullptr slot, so count
+// it as occupied up front.
+atomic<Account*>& AccountTrie::claimSlot(uint32_t index) {
+    atomic<Account*>& slot = node(index).account;
+    if (slot.load(memory_order_relaxed) == nullptr) {
+        count.fetch_add(1, memory_order_relaxed);
+    }
+    return slot;
+}
+
+// Returns the account with the longest number that is a proper prefix of number
+Account* AccountTrie::longestAncestor(string_view number) const {
+    Account* ancestor = nullptr;
+    uint32_t current = 0;
+    for (size_t i = 0; i + 1 < number.size(); ++i) {
+        unsigned digit = digitOf(number[i]);
+        if (digit == 10) {
+            break;
+        }
+        current = node(current).child[digit].load(memory_order_acquire);
+        if (current == 0) {
+            break;
+        }
+        if (Account* account = node(current).account.load(memory_order_acquire)) {
+            ancestor = account;
+        }
+    }
+    return ancestor;
+}
+
+// Allocates the chunks a bulk load will need up front; each account adds
+// about one node in a typical chart
+void AccountTrie::reserve(size_t accounts) {
+    uint64_t last = min<uint64_t>(accounts + accounts / 4 + 1, UINT32_MAX - FIRST_CHUNK);
+    unsigned needed = bit_width(last - 1 + FIRST_CHUNK) - FIRST_CHUNK_SHIFT;
+    for (unsigned chunk = 0; chunk < needed && chunk < MAX_CHUNKS; ++chunk) {
+        if (chunks[chunk] == nullptr) {
+            addChunk(chunk);
+        }
+    }
+}
+
+// Removes every entry but keeps the root. Not safe while readers run.
+void AccountTrie::clear() {
+    freeChunks();
+    nodeCount = 0;
+    count.store(0, memory_order_relaxed);
+    newNode();
+}
+
+// Collects every account whose number starts with prefix
+vector<Account*> AccountTrie::withPrefix(string_view prefix) const {
+    vector<Account*> result;
+    forEachWithPrefix(prefix, [&](Account* account) {
+        result.push_back(account);
+    });
+    return result;
+}
@@ -0,0 +1,184 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: AccountTrie.h
+ * Purpose: Defines the AccountTrie class, a digit trie that indexes accounts
+ *          by number. Because the chart numbers its accounts by prefix
+ *          (1 -> 10 -> 101 -> 1011), the trie mirrors the account hierarchy.
+ *
+ * Fields:
+ *  - Node* chunks[MAX_CHUNKS]: Node storage in chunks that double in size
+ *    (FIRST_CHUNK, 2 * FIRST_CHUNK, ...), so a node never moves once
+ *    created. Node 0 is the root (the empty prefix); children are referenced
+ *    by index, 0 meaning none.
+ *  - uint32_t nodeCount: Nodes handed out so far (including the unused rest
+ *    of NodeBlocks).
+ *  - mutex blockMutex: Serializes handing out NodeBlocks.
+ *  - atomic<size_t> count: Number of accounts stored.
+ *
+ * Concurrency: one writer (emplace, reserve) may run alongside any number of
+ * readers (find, longestAncestor, forEachWithPrefix) without locks. A new
+ * node is fully written before the child link that reaches it is stored
+ * with release order, and an account is published the same way through its
+ * slot; readers load links and slots with acquire order. Nodes are never
+ * moved or freed while the trie is in use, so no reclamation is needed.
+ * clear() must not run concurrently with readers.
+ *
+ * Bulk loads may also build paths on several threads with emplacePath, as
+ * long as no two threads create nodes below the same node: each thread then
+ * stays the only writer of the links it stores. Node indices come from
+ * per-thread NodeBlocks, so threads only meet once per BLOCK_NODES nodes.
+ *
+ * Functions:
+ *  - Account* find(string_view number) const:
+ *      Exact lookup, O(length of number).
+ *  - atomic<Account*>& emplace(string_view number):
+ *      Returns the slot for number, creating the path if needed. The slot is
+ *      nullptr for a new number; store the account with release order to
+ *      publish it. The reference stays valid until clear().
+ *  - uint32_t emplacePath(string_view number, NodeBlock& block):
+ *      Returns the node for number, creating missing nodes from block.
+ *  - atomic<Account*>& claimSlot(uint32_t index):
+ *      The account slot of a node from emplacePath, counted if still empty,
+ *      as emplace does.
+ *  - Account* accountAt(uint32_t index) const:
+ *      The account stored at a node from emplacePath, or nullptr.
+ *  - uint32_t nodeBound() const:
+ *      One past the highest node index handed out, e.g. to size a side table.
+ *  - Account* longestAncestor(string_view number) const:
+ *      Returns the account with the longest number that is a proper prefix of
+ *      number, or nullptr if there is none.
+ *  - void forEachWithPrefix(string_view prefix, Visitor visit) const:
+ *      Visits every account whose number starts with prefix in subtree
+ *      (ascending lexicographic) order, in O(prefix + results).
+ */
+
+#ifndef ACCOUNT_TRIE_H
+#define ACCOUNT_TRIE_H
+
+#include <string_view>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+class Account;
+
+/**
+ * Class: AccountTrie
+ * Purpose: 10-way digit trie mapping account numbers to accounts. The trie
+ *          does not own the accounts it indexes.
+ */
+class AccountTrie {
+public:
+    static constexpr uint32_t BLOCK_NODES = 512;  // Nodes a loader thread takes at a time
+
+    // Node indices set aside for one thread building paths with emplacePath
+    struct NodeBlock {
+        uint32_t next = 0;
+        uint32_t end = 0;
+    };
+
+private:
+    // One node per distinct prefix; 48 bytes, so a lookup touches one line per digit
+    struct Node {
+        atomic<uint32_t> child[10];  // Index of the child for each digit, 0 if absent
+        atomic<Account*> account;    // Account whose number ends here, if any
+    };
+
+    static constexpr unsigned FIRST_CHUNK_SHIFT = 10;                // 1024 nodes in chunk 0
+    static constexpr uint32_t FIRST_CHUNK = 1u << FIRST_CHUNK_SHIFT;
+    static constexpr unsigned MAX_CHUNKS = 32 - FIRST_CHUNK_SHIFT;  // Covers every uint32_t index
+
+    Node* chunks[MAX_CHUNKS];  // Chunk k holds FIRST_CHUNK << k nodes; never moved
+    uint32_t nodeCount;        // Nodes handed out (writer, or under blockMutex)
+    atomic<size_t> count;      // Number of accounts stored
+    mutex blockMutex;          // Guards nodeCount while several threads build paths
+
+    // Locates node index: chunk k starts at index FIRST_CHUNK * (2^k - 1)
+    Node& node(uint32_t index) const {
+        uint64_t position = uint64_t(index) + FIRST_CHUNK;
+        unsigned chunk = bit_width(position) - 1 - FIRST_CHUNK_SHIFT;
+        return chunks[chunk][position - (uint64_t(FIRST_CHUNK) << chunk)];
+    }
+
+    // Creates a zeroed node, allocating its chunk if needed (writer only)
+    uint32_t newNode();
+
+    // Takes a zeroed node from block, refilling the block first if it is used up
+    uint32_t newNode(NodeBlock& block);
+
+    // Allocates chunk k, zeroed
+    void addChunk(unsigned chunk);
+
+    // Frees every chunk
+    void freeChunks();
+
+    // Maps a character to its digit, or returns 10 for anything else
+    static unsigned digitOf(char c) {
+        unsigned digit = static_cast<unsigned char>(c) - '0';
+        return digit < 10 ? digit : 10;
+    }
+
+    // Returns the node reached by following prefix, or 0 if the path is missing
+    uint32_t findNode(string_view prefix) const;
+
+public:
+    AccountTrie();
+    ~AccountTrie();
+
+    AccountTrie(const AccountTrie&) = delete;
+    AccountTrie& operator=(const AccountTrie&) = delete;
+
+    Account* find(string_view number) const;              // Exact lookup
+    atomic<Account*>& emplace(string_view number);        // Finds or creates a slot
+    uint32_t emplacePath(string_view number, NodeBlock& block);  // Finds or creates a node, one thread per subtree
+    atomic<Account*>& claimSlot(uint32_t index);          // Slot of an emplacePath node
+    Account* accountAt(uint32_t index) const { return node(index).account.load(memory_order_acquire); }
+    void prefetchSlot(uint32_t index) const { __builtin_prefetch(&node(index).account); }
+    Account* longestAncestor(string_view number) const;   // Deepest proper-prefix account
+
+    size_t size() const { return count.load(memory_order_relaxed); }
+    uint32_t nodeBound() const { return nodeCount; }  // Every node index is below this (writer only)
+    void reserve(size_t accounts);  // Pre-sizes the node array
+    void clear();                   // Removes every entry (does not delete accounts)
+
+    // Visits every account whose number starts with prefix, in subtree order
+    template <typename Visitor>
+    void forEachWithPrefix(string_view prefix, Visitor visit) const;
+
+    // Collects every account whose number starts with prefix, in subtree order
+    vector<Account*> withPrefix(string_view prefix) const;
+};
+
+// Pre-order walk below the prefix node with an explicit stack. Digits are
+// pushed in reverse so that they pop in ascending order.
+template <typename Visitor>
+void AccountTrie::forEachWithPrefix(string_view prefix, Visitor visit) const {
+    uint32_t start = prefix.empty() ? 0 : findNode(prefix);
+    if (!prefix.empty() && start == 0) {
+        return;
+    }
+
+    vector<uint32_t> stack;
+    stack.push_back(start);
+    while (!stack.empty()) {
+        const Node& current = node(stack.back());
+        stack.pop_back();
+
+        if (Account* account = current.account.load(memory_order_acquire)) {
+            visit(account);
+        }
+        for (int digit = 9; digit >= 0; --digit) {
+            if (uint32_t child = current.child[digit].load(memory_order_acquire)) {
+                stack.push_back(child);
+            }
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,264 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: ChartLoader.cpp
+ * Purpose: Implements the ChartLoader class. The input is scanned once with
+ *          memchr, each line is split into string_view tokens, and every
+ *          account number is validated exactly once before insertion. Large
+ *          inputs are split and validated in parallel chunks.
+ */
+
+#include "ChartLoader.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+// Returns true for the whitespace characters trimmed from tokens
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Removes leading and trailing blanks without copying
+string_view trim(string_view text) {
+    size_t begin = 0;
+    size_t end = text.size();
+    while (begin < end && isBlank(text[begin])) ++begin;
+    while (end > begin && isBlank(text[end - 1])) --end;
+    return text.substr(begin, end - begin);
+}
+
+// Validates that every character is a decimal digit
+bool isAllDigits(string_view text) {
+    if (text.empty()) {
+        return false;
+    }
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+// Constructor: Binds the loader to a tree; quiet by default
+ChartLoader::ChartLoader(ForestTree& tree, ostream& log)
+    : tree(tree), verbose(false), threads(0), log(log) {}
+
+// Maps the file and loads every line
+bool ChartLoader::loadFile(const string& filename) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        log << "Error: Could not open file " << filename << endl;
+        return false;
+    }
+
+    if (verbose) {
+        log << "Loading accounts from file: " << filename << "\n";
+    }
+
+    loadBuffer(file.contents());
+    return true;
+}
+
+// Loads accounts from text that is already in memory, on several threads
+// when the text is large enough to be worth it
+void ChartLoader::loadBuffer(string_view text) {
+    auto start = chrono::steady_clock::now();
+
+    last = ChartLoadStats();
+    last.bytes = text.size();
+
+    unsigned threadCount = threads ? threads : max(1u, thread::hardware_concurrency());
+    if (threadCount > 1 && !verbose && text.size() >= PARALLEL_MIN_BYTES) {
+        loadParallel(text, threadCount);
+    } else {
+        loadSerial(text);
+    }
+
+    auto parsed = chrono::steady_clock::now();
+    last.seconds = chrono::duration<double>(parsed - start).count();
+
+    // Link parents once for the whole load instead of once per account
+    tree.linkHierarchy(last.threads);
+    last.linkSeconds = chrono::duration<double>(chrono::steady_clock::now() - parsed).count();
+}
+
+// Scans the text once with memchr, inserting each line as it is parsed
+void ChartLoader::loadSerial(string_view text) {
+    // One line per account, so the newline count bounds the table size
+    tree.reserveAccounts(tree.size() + count(text.begin(), text.end(), '\n') + 1);
+
+    const char* cursor = text.data();
+    const char* end = cursor + text.size();
+    while (cursor < end) {
+        const char* newline = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+        const char* lineEnd = newline ? newline : end;
+        parseLine(string_view(cursor, lineEnd - cursor));
+        cursor = lineEnd + 1;
+    }
+}
+
+// Cuts the text into chunks that end at a newline and parses them on a
+// pool, then hands the accounts to ForestTree::insertAccounts in file order,
+// which builds their trie paths on the same number of threads.
+void ChartLoader::loadParallel(string_view text, unsigned threadCount) {
+    last.threads = threadCount;
+
+    // A few chunks per thread so a slow chunk does not hold up the rest
+    size_t target = max(MIN_CHUNK_BYTES, text.size() / (threadCount * 4) + 1);
+    vector<ChartChunk> chunks;
+    for (size_t begin = 0; begin < text.size();) {
+        size_t end = text.size();
+        if (text.size() - begin > target) {
+            size_t newline = text.find('\n', begin + target);
+            end = newline == string_view::npos ? text.size() : newline + 1;
+        }
+        chunks.emplace_back();
+        chunks.back().text = text.substr(begin, end - begin);
+        begin = end;
+    }
+
+    {
+        ThreadPool pool(threadCount);
+        vector<future<void>> parsed;
+        parsed.reserve(chunks.size());
+        for (ChartChunk& chunk : chunks) {
+            parsed.push_back(pool.submit([&chunk] { parseChunk(chunk); }));
+        }
+        for (future<void>& done : parsed) {
+            done.get();
+        }
+    }
+
+    size_t accounts = 0;
+    for (const ChartChunk& chunk : chunks) {
+        accounts += chunk.accounts.size();
+        last.lines += chunk.lines;
+        last.invalidNumbers += chunk.invalidNumbers;
+        last.invalidLines += chunk.invalidLines;
+    }
+
+    // Merge the batches in file order and insert them together
+    vector<pair<string_view, string_view>> batch;
+    batch.reserve(accounts);
+    for (const ChartChunk& chunk : chunks) {
+        batch.insert(batch.end(), chunk.accounts.begin(), chunk.accounts.end());
+    }
+    tree.reserveAccounts(tree.size() + accounts);
+    last.accountsAdded = tree.insertAccounts(batch, threadCount);
+    last.duplicates = accounts - last.accountsAdded;
+}
+
+// Splits every line of one chunk into validated (number, description) pairs
+void ChartLoader::parseChunk(ChartChunk& chunk) {
+    // Chart lines average well over 16 bytes, so this rarely regrows
+    chunk.accounts.reserve(chunk.text.size() / 16);
+
+    const char* cursor = chunk.text.data();
+    const char* end = cursor + chunk.text.size();
+    while (cursor < end) {
+        const char* newline = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+        const char* lineEnd = newline ? newline : end;
+        string_view number, description;
+        switch (splitLine(string_view(cursor, lineEnd - cursor), number, description)) {
+        case LineKind::Blank:
+            break;
+        case LineKind::InvalidLine:
+            ++chunk.lines;
+            ++chunk.invalidLines;
+            break;
+        case LineKind::InvalidNumber:
+            ++chunk.lines;
+            ++chunk.invalidNumbers;
+            break;
+        case LineKind::Account:
+            ++chunk.lines;
+            chunk.accounts.emplace_back(number, description);
+            break;
+        }
+        cursor = lineEnd + 1;
+    }
+}
+
+// Trims the line and splits it at the first space or tab. number and
+// description are set for accounts and invalid numbers.
+ChartLoader::LineKind ChartLoader::splitLine(string_view line, string_view& number, string_view& description) {
+    line = trim(line);
+    if (line.empty()) {
+        return LineKind::Blank;
+    }
+
+    size_t split = line.find_first_of(" \t");
+    if (split == string_view::npos) {
+        return LineKind::InvalidLine;
+    }
+
+    number = line.substr(0, split);
+    description = trim(line.substr(split + 1));
+    return isAllDigits(number) ? LineKind::Account : LineKind::InvalidNumber;
+}
+
+// Parses a single line and inserts the account it describes
+void ChartLoader::parseLine(string_view line) {
+    string_view number, description;
+    LineKind kind = splitLine(line, number, description);
+    if (kind == LineKind::Blank) {
+        return;  // Skip empty lines
+    }
+    ++last.lines;
+
+    if (kind == LineKind::InvalidLine) {
+        ++last.invalidLines;
+        if (verbose) {
+            log << "Invalid line format: " << trim(line) << "\n";
+        }
+        return;
+    }
+
+    if (verbose) {
+        log << trim(line) << " -> Account number: " << number << ", Description: " << description << "\n";
+    }
+
+    if (kind == LineKind::InvalidNumber) {
+        ++last.invalidNumbers;
+        if (verbose) {
+            log << "Invalid account number found: " << number << " - Skipping.\n";
+        }
+        return;
+    }
+
+    // The number is already validated and trimmed, so insert without re-checking
+    if (tree.insertAccount(number, description)) {
+        ++last.accountsAdded;
+    } else {
+        ++last.duplicates;
+        if (verbose) {
+            log << "Duplicate account found: " << number << " - Skipping.\n";
+        }
+    }
+}
+
+// Writes a one-line summary of the last load
+void ChartLoader::printStats(ostream& os) const {
+    os << "Loaded " << last.accountsAdded << " accounts from " << last.lines << " lines";
+    size_t skipped = last.duplicates + last.invalidNumbers + last.invalidLines;
+    if (skipped > 0) {
+        os << " (" << skipped << " skipped)";
+    }
+    os << " in " << last.seconds * 1000.0 << " ms";
+    if (last.threads > 1) {
+        os << " on " << last.threads << " threads";
+    }
+    os << ": "
+       << static_cast<size_t>(last.linesPerSecond()) << " lines/s, "
+       << last.bytesPerSecond() / (1024.0 * 1024.0) << " MB/s, linked in "
+       << last.linkSeconds * 1000.0 << " ms\n";
+}
@@ -0,0 +1,129 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: ChartLoader.h
+ * Purpose: Defines the ChartLoader class, a bulk loader that memory-maps a
+ *          chart-of-accounts file and inserts its accounts into a ForestTree
+ *          without copying or re-validating each line.
+ *
+ * File format:
+ *  - One account per line: "<number> <description>". The number is the text
+ *    before the first space or tab, the description is the trimmed rest.
+ *  - Blank lines are skipped; lines may end in "\n" or "\r\n".
+ *
+ * Parallel loading:
+ *  - Inputs of PARALLEL_MIN_BYTES or more are cut into chunks at newline
+ *    boundaries, and a ThreadPool splits, trims and validates the chunks
+ *    into per-chunk account batches. The batches are merged in file order
+ *    and inserted with ForestTree::insertAccounts, whose trie paths are built
+ *    in parallel, then linked once per leading digit in parallel. Account
+ *    ids, duplicate handling and every report are the same as for a serial
+ *    load.
+ *  - Verbose loads stay on one thread so diagnostics keep file order.
+ *
+ * Functions:
+ *  - bool loadFile(const string& filename):
+ *      Maps the file and loads every line. Returns false if it cannot be opened.
+ *  - void loadBuffer(string_view text):
+ *      Loads accounts from text that is already in memory, then links the
+ *      parent/child hierarchy once for the whole batch.
+ *  - void setVerbose(bool verbose):
+ *      Echoes every parsed line and every skipped line to the log stream.
+ *  - void setThreads(unsigned threads):
+ *      Parser threads for large inputs; 0 (the default) uses one per
+ *      hardware thread and 1 always loads serially.
+ *  - const ChartLoadStats& stats() const:
+ *      Returns counters and timing for the most recent load.
+ */
+
+#ifndef CHART_LOADER_H
+#define CHART_LOADER_H
+
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <cstddef>
+#include <vector>
+#include "ForestTree.h"
+
+using namespace std;
+
+/**
+ * Struct: ChartLoadStats
+ * Purpose: Counters and timing gathered while loading a chart.
+ */
+struct ChartLoadStats {
+    size_t lines = 0;           // Non-blank lines seen
+    size_t bytes = 0;           // Input size in bytes
+    size_t accountsAdded = 0;   // Accounts inserted into the tree
+    size_t duplicates = 0;      // Lines whose number already existed
+    size_t invalidNumbers = 0;  // Lines whose number was not numeric
+    size_t invalidLines = 0;    // Lines without a number/description split
+    double seconds = 0;         // Wall-clock time spent parsing and inserting
+    double linkSeconds = 0;     // Wall-clock time spent linking the hierarchy
+    unsigned threads = 1;       // Threads that parsed the input
+
+    double linesPerSecond() const { return seconds > 0 ? lines / seconds : 0; }
+    double bytesPerSecond() const { return seconds > 0 ? bytes / seconds : 0; }
+};
+
+/**
+ * Class: ChartLoader
+ * Purpose: Parses chart-of-accounts text with string_view tokens and inserts
+ *          each account straight into a ForestTree. Quiet unless verbose.
+ */
+class ChartLoader {
+public:
+    static constexpr size_t PARALLEL_MIN_BYTES = 1 << 20;  // Smaller inputs load serially
+    static constexpr size_t MIN_CHUNK_BYTES = 256 << 10;   // Smallest chunk worth a task
+
+private:
+    // Outcome of splitting one line
+    enum class LineKind { Blank, Account, InvalidLine, InvalidNumber };
+
+    // One chunk's accounts, still pointing into the input, and its counters
+    struct ChartChunk {
+        string_view text;
+        vector<pair<string_view, string_view>> accounts;  // (number, description)
+        size_t lines = 0;
+        size_t invalidNumbers = 0;
+        size_t invalidLines = 0;
+    };
+
+    ForestTree& tree;       // Destination tree
+    bool verbose;           // Echo per-line diagnostics when true
+    unsigned threads;       // Parser threads; 0 for one per hardware thread
+    ostream& log;           // Destination for diagnostics
+    ChartLoadStats last;    // Statistics for the most recent load
+
+    // Trims a line and splits it into a validated number and a description
+    static LineKind splitLine(string_view line, string_view& number, string_view& description);
+
+    // Parses a single line (without its terminator) and inserts the account
+    void parseLine(string_view line);
+
+    // Loads text on one thread, inserting each line as it is parsed
+    void loadSerial(string_view text);
+
+    // Parses chunks on a thread pool, then inserts them in order
+    void loadParallel(string_view text, unsigned threadCount);
+
+    // Splits and validates every line of chunk.text; safe on any thread
+    static void parseChunk(ChartChunk& chunk);
+
+public:
+    explicit ChartLoader(ForestTree& tree, ostream& log = cout);
+
+    void setVerbose(bool verbose) { this->verbose = verbose; }
+    void setThreads(unsigned threads) { this->threads = threads; }
+
+    bool loadFile(const string& filename);  // Maps and loads a file
+    void loadBuffer(string_view text);      // Loads in-memory text
+
+    const ChartLoadStats& stats() const { return last; }
+
+    // Writes a one-line summary of the last load, including throughput
+    void printStats(ostream& os) const;
+};
+
+#endif
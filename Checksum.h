@@ -0,0 +1,22 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: Checksum.h
+ * Purpose: Declares the CRC-32 checksum used to detect torn or corrupted
+ *          records in the journal and snapshot files.
+ *
+ * Functions:
+ *  - uint32_t crc32(const void* data, size_t length, uint32_t crc = 0):
+ *      Standard CRC-32 (IEEE 802.3). Pass a previous result as crc to
+ *      checksum data that arrives in pieces.
+ */
+
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <cstdint>
+#include <cstddef>
+
+uint32_t crc32(const void* data, size_t length, uint32_t crc = 0);
+
+#endif
@@ -0,0 +1,207 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: CowColumn.h
+ * Purpose: Defines CowColumn, a paged array with copy-on-write snapshots.
+ *          Freezing a column shares its pages in O(1); afterwards only the
+ *          pages that are written again are copied.
+ *
+ * Values live in fixed pages of PAGE_SIZE entries, listed in a page table.
+ * Every page and the table carry the epoch in which they were created. The
+ * column only writes in place to objects of its current epoch; freeze()
+ * moves the column to a new epoch, so everything a frozen copy can see is
+ * older and gets copied before the next write to it (first the table, then
+ * the one page being written). Readers of a frozen copy therefore never see
+ * a change, and may run on other threads while the column is written.
+ *
+ * Functions:
+ *  - const T& operator[](size_t index) const: Reads one value.
+ *  - T& mutate(size_t index): Returns a writable reference, copying the
+ *    table and the page first if a frozen copy shares them.
+ *  - void push_back(T value) / reserve / clear / size: As for a vector.
+ *  - void grow(size_t length, T value): Appends copies of value until the
+ *    column holds length values, a page at a time.
+ *  - void assign(const T* values, size_t count) / assign(const CowColumn& other):
+ *      Replaces the contents with a private copy.
+ *  - void forEachRun(Visitor visit) const: Calls visit(first, values, count)
+ *    for each page's contiguous run of values, for column scans.
+ *  - Frozen freeze(): Returns a read-only view of the current contents.
+ *  - void makeWritable(): Copies every shared page now, so that later
+ *    writes never allocate (needed before concurrent writers use mutate).
+ */
+
+#ifndef COW_COLUMN_H
+#define COW_COLUMN_H
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Class: CowColumn
+ * Purpose: Column of trivially copyable values with O(1) frozen copies.
+ */
+template <typename T>
+class CowColumn {
+public:
+    static constexpr size_t PAGE_SHIFT = 12;  // 4096 values per page
+    static constexpr size_t PAGE_SIZE = size_t(1) << PAGE_SHIFT;
+    static constexpr size_t PAGE_MASK = PAGE_SIZE - 1;
+
+private:
+    struct Page {
+        uint64_t epoch;
+        T values[PAGE_SIZE];
+    };
+
+    struct Table {
+        uint64_t epoch;
+        vector<shared_ptr<Page>> pages;
+    };
+
+    shared_ptr<Table> table;
+    size_t count;     // Values in the column
+    uint64_t epoch;   // Objects tagged with this epoch are not shared
+    bool exclusive;   // Nothing is shared: writes skip the epoch checks
+
+    // The page table, copied first if a frozen view shares it
+    Table& writableTable() {
+        if (table->epoch != epoch) {
+            auto copy = make_shared<Table>(*table);
+            copy->epoch = epoch;
+            table = move(copy);
+        }
+        return *table;
+    }
+
+    // One page, copied first if a frozen view shares it
+    Page& writablePage(size_t index) {
+        Page* page = table->pages[index].get();
+        if (exclusive || (page->epoch == epoch && table->epoch == epoch)) {
+            return *page;  // Fast path: this page is not shared
+        }
+        shared_ptr<Page>& slot = writableTable().pages[index];
+        if (slot->epoch != epoch) {
+            auto copy = make_shared<Page>(*slot);
+            copy->epoch = epoch;
+            slot = move(copy);
+        }
+        return *slot;
+    }
+
+public:
+    /**
+     * Class: CowColumn::Frozen
+     * Purpose: Read-only view of a column as it was when frozen.
+     */
+    class Frozen {
+    private:
+        shared_ptr<const Table> table;
+        size_t count;
+
+    public:
+        Frozen() : count(0) {}
+        Frozen(shared_ptr<const Table> table, size_t count) : table(move(table)), count(count) {}
+
+        const T& operator[](size_t index) const {
+            return table->pages[index >> PAGE_SHIFT]->values[index & PAGE_MASK];
+        }
+        size_t size() const { return count; }
+    };
+
+    CowColumn() : table(make_shared<Table>()), count(0), epoch(0), exclusive(true) {
+        table->epoch = epoch;
+    }
+
+    CowColumn(const CowColumn&) = delete;
+    CowColumn& operator=(const CowColumn&) = delete;
+
+    const T& operator[](size_t index) const {
+        return table->pages[index >> PAGE_SHIFT]->values[index & PAGE_MASK];
+    }
+
+    T& mutate(size_t index) {
+        return writablePage(index >> PAGE_SHIFT).values[index & PAGE_MASK];
+    }
+
+    size_t size() const { return count; }
+
+    void push_back(T value) {
+        if ((count & PAGE_MASK) == 0) {
+            auto page = make_shared<Page>();
+            page->epoch = epoch;
+            writableTable().pages.push_back(move(page));
+        }
+        mutate(count) = value;
+        ++count;
+    }
+
+    void grow(size_t length, T value) {
+        while (count < length) {
+            if ((count & PAGE_MASK) == 0) {
+                auto page = make_shared<Page>();
+                page->epoch = epoch;
+                writableTable().pages.push_back(move(page));
+            }
+            size_t pageEnd = min(length, (count | PAGE_MASK) + 1);
+            T* values = writablePage(count >> PAGE_SHIFT).values;
+            fill(values + (count & PAGE_MASK), values + (count & PAGE_MASK) + (pageEnd - count), value);
+            count = pageEnd;
+        }
+    }
+
+    void reserve(size_t values) {
+        writableTable().pages.reserve((values + PAGE_MASK) >> PAGE_SHIFT);
+    }
+
+    void clear() {
+        table = make_shared<Table>();
+        table->epoch = epoch;
+        count = 0;
+        exclusive = true;
+    }
+
+    // Replaces the first count values; the column must hold at least count
+    void assign(const T* values, size_t length) {
+        for (size_t first = 0; first < length; first += PAGE_SIZE) {
+            Page& page = writablePage(first >> PAGE_SHIFT);
+            copy(values + first, values + min(length, first + PAGE_SIZE), page.values);
+        }
+    }
+
+    // Makes this column a private copy of other (same size)
+    void assign(const CowColumn& other) {
+        other.forEachRun([&](size_t first, const T* values, size_t length) {
+            copy(values, values + length, writablePage(first >> PAGE_SHIFT).values);
+        });
+    }
+
+    template <typename Visitor>
+    void forEachRun(Visitor visit) const {
+        for (size_t first = 0; first < count; first += PAGE_SIZE) {
+            visit(first, table->pages[first >> PAGE_SHIFT]->values, min(PAGE_SIZE, count - first));
+        }
+    }
+
+    // O(1): the view shares the table, and the column moves to a new epoch
+    Frozen freeze() {
+        Frozen view(table, count);
+        ++epoch;
+        exclusive = false;
+        return view;
+    }
+
+    void makeWritable() {
+        for (size_t index = 0; index < table->pages.size(); ++index) {
+            writablePage(index);
+        }
+        writableTable();
+        exclusive = true;
+    }
+};
+
+#endif
@@ -0,0 +1,336 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: FinancialReports.cpp
+ * Purpose: Implements the single-pass aggregation and the trial balance,
+ *          balance sheet and income statement layouts (text and CSV).
+ */
+
+#include "FinancialReports.h"
+#include "ForestTree.h"
+#include "ReportWriter.h"
+#include "FrozenLedger.h"
+#include <string>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+
+using namespace std;
+
+// Aggregates the forest. The tree must be linked (the ForestTree print
+// functions link it first). The walk records each account's line, depth,
+// parent line and own totals in pre-order for accumulate().
+FinancialReports::FinancialReports(const ForestTree& tree) {
+    const AccountColumns& columns = tree.store.columns;
+    const size_t count = tree.store.size();
+    lines.reserve(count);
+    levels.reserve(count);
+    debits.reserve(count);
+    credits.reserve(count);
+    lineById.assign(count, 0);
+
+    vector<uint32_t> parentLines;
+    parentLines.reserve(count);
+
+    struct Pending {
+        const Account* account;
+        uint32_t parentLine;
+        uint16_t level;
+    };
+    vector<Pending> stack;
+    for (const Account* root : tree.roots) {
+        size_t begin = lines.size();
+        stack.push_back(Pending{root, NO_LINE, 0});
+        while (!stack.empty()) {
+            Pending next = stack.back();
+            stack.pop_back();
+
+            uint32_t line = static_cast<uint32_t>(lines.size());
+            uint32_t id = next.account->id;
+            lines.push_back(next.account);
+            levels.push_back(next.level);
+            parentLines.push_back(next.parentLine);
+            debits.push_back(columns.debitTotals[id]);
+            credits.push_back(columns.creditTotals[id]);
+            lineById[id] = line;
+
+            const vector<Account*>& children = next.account->children;
+            for (auto it = children.rbegin(); it != children.rend(); ++it) {
+                stack.push_back(Pending{*it, line, static_cast<uint16_t>(next.level + 1)});
+            }
+        }
+        classes.push_back(ClassRange{begin, lines.size(), root->number[0]});
+    }
+    accumulate(parentLines);
+}
+
+// Aggregates a frozen period. Its accounts are the ones with an id below
+// the ledger's size, and its hierarchy is the frozen parent column. The
+// trie visits numbers in ascending order, which is hierarchy pre-order
+// (every parent's number is a prefix of its children's), so each parent's
+// line exists before its children ask for it.
+FinancialReports::FinancialReports(const FrozenLedger& ledger) {
+    const size_t count = ledger.size();
+    lines.reserve(count);
+    levels.reserve(count);
+    debits.reserve(count);
+    credits.reserve(count);
+    lineById.assign(count, 0);
+
+    vector<uint32_t> parentLines;
+    parentLines.reserve(count);
+
+    ledger.tree->accounts.forEachWithPrefix("", [&](const Account* account) {
+        uint32_t id = account->id;
+        if (id >= count) {
+            return;  // Added after the freeze
+        }
+        uint32_t line = static_cast<uint32_t>(lines.size());
+        uint32_t parentId = ledger.parentIds[id];
+        uint32_t parentLine = parentId == AccountColumns::NO_PARENT ? NO_LINE : lineById[parentId];
+        if (parentLine == NO_LINE) {
+            if (!classes.empty()) {
+                classes.back().end = line;
+            }
+            classes.push_back(ClassRange{line, line, account->number[0]});
+        }
+        lines.push_back(account);
+        levels.push_back(parentLine == NO_LINE ? 0 : static_cast<uint16_t>(levels[parentLine] + 1));
+        parentLines.push_back(parentLine);
+        debits.push_back(ledger.debitTotals[id]);
+        credits.push_back(ledger.creditTotals[id]);
+        lineById[id] = line;
+    });
+    if (!classes.empty()) {
+        classes.back().end = lines.size();
+    }
+    accumulate(parentLines);
+}
+
+// Sweeps the lines backwards, which visits every child before its parent,
+// so adding each line's totals into its parent's yields every subtree total
+// in O(n) with sequential access
+void FinancialReports::accumulate(const vector<uint32_t>& parentLines) {
+    for (size_t line = lines.size(); line-- > 0;) {
+        uint32_t parent = parentLines[line];
+        if (parent != NO_LINE) {
+            debits[parent] = (Money::fromMinor(debits[parent]) + Money::fromMinor(debits[line])).minorUnits();
+            credits[parent] = (Money::fromMinor(credits[parent]) + Money::fromMinor(credits[line])).minorUnits();
+        }
+    }
+}
+
+// Applies the depth limit and, unless includeZero, hides inactive subtrees
+bool FinancialReports::listed(size_t index, const FinancialReportOptions& options) const {
+    if (options.maxDepth >= 0 && levels[index] > options.maxDepth) {
+        return false;
+    }
+    return options.includeZero || debits[index] != 0 || credits[index] != 0;
+}
+
+// Writes the indented "number - description", cut and padded to LABEL_WIDTH
+void FinancialReports::writeLabel(ReportWriter& writer, size_t index) const {
+    const Account* account = lines[index];
+    size_t room = LABEL_WIDTH - 1;  // Keep one space before the first amount
+    size_t indent = min(static_cast<size_t>(levels[index]) * ReportWriter::INDENT, room);
+    writer.appendPadding(indent);
+    room -= indent;
+
+    string_view number = string_view(account->number).substr(0, room);
+    writer.append(number);
+    room -= number.size();
+    if (room > 3) {
+        string_view description = account->description().substr(0, room - 3);
+        writer.append(" - ");
+        writer.append(description);
+        room -= 3 + description.size();
+    }
+    writer.appendPadding(room + 1);
+}
+
+// Writes a total line
+void FinancialReports::writeTotal(ReportWriter& writer, const FinancialReportOptions& options, string_view section,
+                                  string_view label, Money amount) const {
+    if (options.format == ReportFormat::Csv) {
+        writer.appendCsvField(section);
+        writer.append(",,");
+        writer.appendCsvField(label);
+        writer.append(",,");
+        writer.appendMoney(amount);
+        writer.append("\n");
+        return;
+    }
+    label = label.substr(0, LABEL_WIDTH - 1);
+    writer.append(label);
+    writer.appendPadding(LABEL_WIDTH - label.size());
+    writer.appendMoney(amount, AMOUNT_WIDTH);
+    writer.append("\n");
+}
+
+// Writes every listed line of the classes first..last and a total per
+// class; returns the sum of the class totals
+Money FinancialReports::writeSection(ReportWriter& writer, const FinancialReportOptions& options, string_view section,
+                                     char first, char last, int sign) const {
+    Money sectionTotal;
+    for (const ClassRange& range : classes) {
+        if (range.digit < first || range.digit > last) {
+            continue;
+        }
+        for (size_t i = range.begin; i < range.end; ++i) {
+            if (!listed(i, options)) {
+                continue;
+            }
+            Money amount = Money::fromMinor(debits[i]) - Money::fromMinor(credits[i]);
+            if (sign < 0) {
+                amount = -amount;
+            }
+            if (options.format == ReportFormat::Csv) {
+                const Account* account = lines[i];
+                writer.appendCsvField(section);
+                writer.append(",");
+                writer.append(account->number);
+                writer.append(",");
+                writer.appendCsvField(account->description());
+                writer.append(",");
+                writer.appendNumber(levels[i]);
+                writer.append(",");
+                writer.appendMoney(amount);
+                writer.append("\n");
+            } else {
+                writeLabel(writer, i);
+                writer.appendMoney(amount, AMOUNT_WIDTH);
+                writer.append("\n");
+            }
+        }
+
+        Money classTotal = Money::fromMinor(debits[range.begin]) - Money::fromMinor(credits[range.begin]);
+        if (sign < 0) {
+            classTotal = -classTotal;
+        }
+        const Account* account = lines[range.begin];
+        string label = "Total " + account->number + " - " + string(account->description());
+        writeTotal(writer, options, section, label, classTotal);
+        sectionTotal += classTotal;
+    }
+    return sectionTotal;
+}
+
+// Trial balance: debit, credit and balance of every account, then totals.
+// Debits equal credits when every entry was posted double-sided.
+void FinancialReports::writeTrialBalance(ReportWriter& writer, const FinancialReportOptions& options) const {
+    Money totalDebits, totalCredits;
+    for (const ClassRange& range : classes) {
+        totalDebits += Money::fromMinor(debits[range.begin]);
+        totalCredits += Money::fromMinor(credits[range.begin]);
+    }
+
+    const bool csv = options.format == ReportFormat::Csv;
+    const size_t ruleWidth = LABEL_WIDTH + 3 * AMOUNT_WIDTH;
+    if (csv) {
+        writer.append("account,description,level,debit,credit,balance\n");
+    } else {
+        writer.append("TRIAL BALANCE\n");
+        writer.append("Account");
+        writer.appendPadding(LABEL_WIDTH - 7 + AMOUNT_WIDTH - 5);
+        writer.append("Debit");
+        writer.appendPadding(AMOUNT_WIDTH - 6);
+        writer.append("Credit");
+        writer.appendPadding(AMOUNT_WIDTH - 7);
+        writer.append("Balance\n");
+        writer.append(string(ruleWidth, '-'));
+        writer.append("\n");
+    }
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (!listed(i, options)) {
+            continue;
+        }
+        Money debit = Money::fromMinor(debits[i]);
+        Money credit = Money::fromMinor(credits[i]);
+        if (csv) {
+            const Account* account = lines[i];
+            writer.append(account->number);
+            writer.append(",");
+            writer.appendCsvField(account->description());
+            writer.append(",");
+            writer.appendNumber(levels[i]);
+            writer.append(",");
+            writer.appendMoney(debit);
+            writer.append(",");
+            writer.appendMoney(credit);
+            writer.append(",");
+            writer.appendMoney(debit - credit);
+            writer.append("\n");
+        } else {
+            writeLabel(writer, i);
+            writer.appendMoney(debit, AMOUNT_WIDTH);
+            writer.appendMoney(credit, AMOUNT_WIDTH);
+            writer.appendMoney(debit - credit, AMOUNT_WIDTH);
+            writer.append("\n");
+        }
+    }
+
+    if (csv) {
+        writer.append("TOTAL,,,");
+        writer.appendMoney(totalDebits);
+        writer.append(",");
+        writer.appendMoney(totalCredits);
+        writer.append(",");
+        writer.appendMoney(totalDebits - totalCredits);
+        writer.append("\n");
+    } else {
+        writer.append(string(ruleWidth, '-'));
+        writer.append("\nTotal");
+        writer.appendPadding(LABEL_WIDTH - 5);
+        writer.appendMoney(totalDebits, AMOUNT_WIDTH);
+        writer.appendMoney(totalCredits, AMOUNT_WIDTH);
+        writer.appendMoney(totalDebits - totalCredits, AMOUNT_WIDTH);
+        writer.append("\n");
+    }
+}
+
+// Balance sheet: classes 1-5 with their balances, then the period result
+// carried in from the income statement classes
+void FinancialReports::writeBalanceSheet(ReportWriter& writer, const FinancialReportOptions& options) const {
+    Money result;  // Credit-positive result of classes 6-7 (a profit is positive)
+    for (const ClassRange& range : classes) {
+        if (range.digit == '6' || range.digit == '7') {
+            result += Money::fromMinor(credits[range.begin]) - Money::fromMinor(debits[range.begin]);
+        }
+    }
+
+    if (options.format == ReportFormat::Csv) {
+        writer.append("section,account,description,level,amount\n");
+    } else {
+        writer.append("BALANCE SHEET\n");
+        writer.append("Account");
+        writer.appendPadding(LABEL_WIDTH - 7 + AMOUNT_WIDTH - 7);
+        writer.append("Balance\n");
+        writer.append(string(LABEL_WIDTH + AMOUNT_WIDTH, '-'));
+        writer.append("\n");
+    }
+
+    Money total = writeSection(writer, options, "Balance sheet", '1', '5', 1);
+    writeTotal(writer, options, "Balance sheet", "Total balance sheet accounts", total);
+    writeTotal(writer, options, "Balance sheet", "Result for the period (classes 6-7)", result);
+}
+
+// Income statement: expenses, revenues and the net income between them
+void FinancialReports::writeIncomeStatement(ReportWriter& writer, const FinancialReportOptions& options) const {
+    if (options.format == ReportFormat::Csv) {
+        writer.append("section,account,description,level,amount\n");
+    } else {
+        writer.append("INCOME STATEMENT\n");
+        writer.append("Account");
+        writer.appendPadding(LABEL_WIDTH - 7 + AMOUNT_WIDTH - 6);
+        writer.append("Amount\n");
+        writer.append(string(LABEL_WIDTH + AMOUNT_WIDTH, '-'));
+        writer.append("\n");
+    }
+
+    Money expenses = writeSection(writer, options, "Expenses", '6', '6', 1);
+    writeTotal(writer, options, "Expenses", "Total expenses", expenses);
+    Money revenues = writeSection(writer, options, "Revenues", '7', '7', -1);
+    writeTotal(writer, options, "Revenues", "Total revenues", revenues);
+    writeTotal(writer, options, "Result", "Net income", revenues - expenses);
+}
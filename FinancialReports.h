@@ -0,0 +1,120 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: FinancialReports.h
+ * Purpose: Defines the FinancialReports class, which aggregates debit and
+ *          credit totals over the whole forest in one pass and writes the
+ *          trial balance, balance sheet and income statement from them.
+ *
+ * Fields (one entry per line, i.e. per account in hierarchy pre-order, so
+ * writing a report reads them front to back):
+ *  - vector<const Account*> lines / vector<uint16_t> levels: The account on
+ *    each line and its depth.
+ *  - vector<Money::Rep> debits / credits: Subtree debit and credit totals.
+ *  - vector<uint32_t> lineById: Line of each account id.
+ *
+ * Functions:
+ *  - FinancialReports(const ForestTree& tree):
+ *      Runs the aggregation. Own totals come from the arena's debit and
+ *      credit columns, so no posting is read; one reverse pre-order
+ *      (children before parents) sweep adds every subtree into its parent.
+ *  - FinancialReports(const FrozenLedger& ledger):
+ *      The same aggregation over a frozen period's columns and hierarchy.
+ *  - Money debitTotal(uint32_t id) const / Money creditTotal(uint32_t id) const:
+ *      Subtree totals of an account.
+ *  - void writeTrialBalance(ReportWriter& writer, const FinancialReportOptions& options):
+ *      Debit, credit and balance of every account, with grand totals.
+ *  - void writeBalanceSheet(ReportWriter& writer, const FinancialReportOptions& options):
+ *      Balances of classes 1-5 and the period result from classes 6-7.
+ *  - void writeIncomeStatement(ReportWriter& writer, const FinancialReportOptions& options):
+ *      Expenses (class 6), revenues (class 7) and net income.
+ *
+ * Balances are debit minus credit. The income statement shows expenses as
+ * debit minus credit and revenues as credit minus debit, so both are usually
+ * positive.
+ */
+
+#ifndef FINANCIAL_REPORTS_H
+#define FINANCIAL_REPORTS_H
+
+#include <vector>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include "Money.h"
+
+using namespace std;
+
+class Account;
+class ForestTree;
+class FrozenLedger;
+class ReportWriter;
+
+enum class ReportFormat { Text, Csv };
+
+/**
+ * Struct: FinancialReportOptions
+ * Purpose: Output format and which lines a financial report lists.
+ */
+struct FinancialReportOptions {
+    ReportFormat format = ReportFormat::Text;
+    int maxDepth = -1;          // Deepest level listed (classes are level 0); -1 for all
+    bool includeZero = false;   // Also list accounts without any postings below them
+};
+
+/**
+ * Class: FinancialReports
+ * Purpose: One aggregation pass shared by the trial balance, the balance
+ *          sheet and the income statement.
+ */
+class FinancialReports {
+private:
+    static constexpr uint32_t NO_LINE = UINT32_MAX;  // Parent line of a class (root)
+
+    vector<const Account*> lines;  // Accounts in hierarchy pre-order
+    vector<uint16_t> levels;       // Depth of each line
+    vector<Money::Rep> debits;     // Subtree debit total of each line
+    vector<Money::Rep> credits;    // Subtree credit total of each line
+    vector<uint32_t> lineById;     // Account id -> line
+
+    // Range of lines covered by each class (root), with the class digit
+    struct ClassRange {
+        size_t begin;
+        size_t end;
+        char digit;
+    };
+    vector<ClassRange> classes;
+
+    // Adds each line's totals into its parent line, children first
+    void accumulate(const vector<uint32_t>& parentLines);
+
+    // True if line index is listed under options
+    bool listed(size_t index, const FinancialReportOptions& options) const;
+
+    // Writes "<indent>number - description" padded to the label column
+    void writeLabel(ReportWriter& writer, size_t index) const;
+
+    // Writes the lines of classes first..last with amount = sign * (debit - credit)
+    Money writeSection(ReportWriter& writer, const FinancialReportOptions& options, string_view section,
+                       char first, char last, int sign) const;
+
+    // Writes a total line ("Total ...") in the format's layout
+    void writeTotal(ReportWriter& writer, const FinancialReportOptions& options, string_view section,
+                    string_view label, Money amount) const;
+
+public:
+    static constexpr size_t LABEL_WIDTH = 60;   // Text layout: account column
+    static constexpr size_t AMOUNT_WIDTH = 18;  // Text layout: each amount column
+
+    explicit FinancialReports(const ForestTree& tree);
+    explicit FinancialReports(const FrozenLedger& ledger);
+
+    Money debitTotal(uint32_t id) const { return Money::fromMinor(debits[lineById[id]]); }
+    Money creditTotal(uint32_t id) const { return Money::fromMinor(credits[lineById[id]]); }
+
+    void writeTrialBalance(ReportWriter& writer, const FinancialReportOptions& options) const;
+    void writeBalanceSheet(ReportWriter& writer, const FinancialReportOptions& options) const;
+    void writeIncomeStatement(ReportWriter& writer, const FinancialReportOptions& options) const;
+};
+
+#endif
@@ -15,21 +15,54 @@
  *
  * Functions:
  *  - ForestTree(): Constructor to initialize an empty forest tree.
- *  - ~ForestTree(): Destructor to clean up dynamically allocated memory.
+ *  - ~ForestTree(): Destructor; accounts are freed with the arena that owns them.
  *  - void addAccount(const string& number, const string& description): Adds a new account
  *      to the forest if it doesn't already exist.
- *  - void addTransaction(const string& accountNumber, double amount, char debitCredit):
- *      Adds a transaction to a specified account.
- *  - void deleteTransaction(const string& accountNumber, int index): Deletes a transaction
- *      from the specified account using the transaction index.
- *  - Account* searchAccount(const string& number): Searches for an account by number
- *      and returns a pointer to the account if found.
+ *  - Account* insertAccount(string_view number, string_view description): Bulk-load
+ *      fast path that inserts a pre-validated account with a single lookup.
+ *  - void linkHierarchy(unsigned threads): Rebuilds parent/child links from
+ *      account-number prefixes in a single ordered walk of the trie, one task
+ *      per leading digit when threads > 1.
+ *  - size_t insertAccounts(span<const pair<string_view, string_view>> batch,
+ *      unsigned threads): Bulk-load fast path that builds the trie paths of
+ *      many pre-validated accounts in parallel, then inserts them in order.
+ *  - void addTransaction(const string& accountNumber, Money amount, char debitCredit,
+ *      int64_t timestamp): Adds a timestamped transaction to a specified account
+ *      and journals it, if a journal is attached.
+ *  - PostingBatchResult postBatch(span<const Posting> postings): Validates, groups and
+ *      applies a batch of postings with a single roll-up propagation.
+ *  - bool postEntry(const JournalEntry& entry) / PostingBatchResult postEntries(
+ *      span<const JournalEntry> entries): Check that each double-entry journal
+ *      entry balances, then apply all of its lines or none of them.
+ *  - uint32_t resolvePosting / const char* checkEntry / const char* stageEntry /
+ *      size_t applyPostings:
+ *      Shared validation and application steps of the batch and entry paths.
+ *  - void deleteTransaction(const string& accountNumber, int id): Deletes a transaction
+ *      from the specified account using its stable transaction ID.
+ *  - bool deletePosting(uint64_t postingId): Deletes a transaction by posting ID.
+ *  - Account* searchAccount(const string& number) const: Searches for an account by number,
+ *      without locks, and returns a pointer to the account if found.
+ *  - vector<Account*> findAccountsWithPrefix(const string& prefix): Lists every
+ *      account under a number prefix straight from the trie.
+ *  - Money sumBalances(const string& prefix): Sums balances under a prefix by
+ *      scanning only the number-key and balance columns.
+ *  - Money balanceAsOf(const string& number, int64_t time) / movementBetween(...):
+ *      Point-in-time balance and period movement of an account and its
+ *      sub-accounts, from each account's time index.
  *  - void printAccountDetails(const string& number, const string& filename): Prints
  *      detailed account information to a file, including subaccounts and transactions.
- *  - void printForestTree(const string& filename): Writes the hierarchical structure
- *      of the entire forest tree to a file.
- *  - void printAccountHierarchy(ostream& os, Account* account, int level): Helper function
- *      to recursively print account hierarchy.
+ *  - void printForestTree(const string& filename, const ReportOptions& options): Writes
+ *      the hierarchical structure of the entire forest tree to a file, rendering the
+ *      account classes in parallel.
+ *  - void printClassFiles(const string& filename, const ReportOptions& options,
+ *      unsigned threads): Writes each account class to its own file in parallel.
+ *  - void printTrialBalance / printBalanceSheet / printIncomeStatement(const string& filename,
+ *      const FinancialReportOptions& options): Write the financial reports.
+ *  - void printFinancialReport(...): Shared validation and output for those reports.
+ *  - FrozenLedger freeze(): Shares the hierarchy and balance columns with a
+ *      read-only ledger for period-close reporting.
+ *  - void printAccountHierarchy(ReportWriter& writer, Account* account, int level,
+ *      const ReportOptions& options): Helper function to write one account's hierarchy.
  */
 
 #include "ForestTree.h"
@@ -39,18 +72,16 @@
 #include <algorithm>
 
 #include <filesystem>
+#include <future>
+#include "ThreadPool.h"
 
 using namespace std;
 
 // Constructor: Initializes an empty forest tree
-ForestTree::ForestTree() {}
+ForestTree::ForestTree() : hierarchyDirty(false), journal(nullptr) {}
 
-// Destructor: Cleans up dynamically allocated memory
-ForestTree::~ForestTree() {
-    for (auto& accountPair : accounts) {
-        delete accountPair.second; // Deletes each Account object
-    }
-}
+// Destructor: The arena releases every account when it is destroyed
+ForestTree::~ForestTree() {}
 
 // Adds a new account to the forest tree if it doesn't already exist
 void ForestTree::addAccount(const string& number, const string& description) {
@@ -75,20 +106,255 @@ void ForestTree::addAccount(const string& number, const string& description) {
         return;
     }
 
-    // Check if account already exists
-    if (accounts.find(trimmedNumber) != accounts.end()) {
+    // Bring any bulk-loaded accounts into the hierarchy before linking this one
+    if (hierarchyDirty) {
+        linkHierarchy();
+    }
+
+    // Its roll-up starts as the sum of the sub-accounts it adopts
+    if (!adoptionFits(trimmedNumber)) {
+        cout << "Error: The sub-accounts' combined balance is out of range.\n";
+        return;
+    }
+
+    // Create a new account and add it to the tree unless it already exists
+    Account* newAccount = insertAccount(trimmedNumber, trimmedDescription);
+    if (newAccount == nullptr) {
         cout << "Error: Account already exists.\n";
         return;
     }
 
-    // Create a new account and add it to the tree
-    Account* newAccount = new Account(trimmedNumber, trimmedDescription);
-    accounts[trimmedNumber] = newAccount;  // Add to the forest
+    linkAccount(newAccount);
+    hierarchyDirty = false;
+
+    if (journal) {
+        journal->logAccount(trimmedNumber, trimmedDescription);
+    }
+}
+
+// Links a single account under its nearest ancestor, at its place in number
+// order. Siblings that fall under the new number (e.g. 1011 when 101 is
+// added below 10) move beneath it, keeping their order.
+void ForestTree::linkAccount(Account* account) {
+    Account* parent = accounts.longestAncestor(account->number);
+    vector<Account*>& siblings = parent ? parent->children : roots;
+
+    auto adopted = stable_partition(siblings.begin(), siblings.end(), [&](Account* sibling) {
+        return !account->isAncestorOf(sibling->number);
+    });
+    AccountColumns& columns = store.columns;
+    for (auto it = adopted; it != siblings.end(); ++it) {
+        account->addChild(*it);
+        // Ancestors already include the adopted subtree, so only the new account changes
+        Money::Rep& rollup = columns.rollups.mutate(account->id);
+        rollup = (Money::fromMinor(rollup) + Money::fromMinor(columns.rollups[(*it)->id])).minorUnits();
+    }
+    siblings.erase(adopted, siblings.end());
+
+    if (parent) {
+        parent->addChild(account);
+    } else {
+        account->clearParent();
+        Account::insertSorted(roots, account);
+    }
+}
+
+// Sums the roll-ups of the siblings that linkAccount would move under a new
+// account, in the same order, and reports whether every step fits
+bool ForestTree::adoptionFits(string_view number) const {
+    Account* parent = accounts.longestAncestor(number);
+    const vector<Account*>& siblings = parent ? parent->children : roots;
+    Money::Rep adopted = 0;
+    for (const Account* sibling : siblings) {
+        if (sibling->number.size() > number.size() && sibling->number.compare(0, number.size(), number) == 0 &&
+            __builtin_add_overflow(adopted, store.columns.rollups[sibling->id], &adopted)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Rebuilds the whole hierarchy in one pass. The trie yields accounts in
+// ascending order, where every account's descendants directly follow it, so
+// a stack of the current ancestor chain gives each account's parent. Roll-up
+// balances are then recomputed bottom-up in linear time. With several
+// threads, each leading digit is linked as its own task: no account has an
+// ancestor under another digit, and each task writes only its own accounts.
+void ForestTree::linkHierarchy(unsigned threads) {
+    AccountColumns& columns = store.columns;
+    columns.rollups.assign(columns.balances);
+
+    // Links every account under prefix, appending the top-level ones to top
+    auto linkSubtree = [&](string_view prefix, vector<Account*>& top) {
+        vector<Account*> chain;  // Ancestors of the account being linked
+        vector<uint32_t> order;  // Account ids in pre-order, for the roll-up pass
+        accounts.forEachWithPrefix(prefix, [&](Account* account) {
+            account->clearParent();
+            account->children.clear();
+            order.push_back(account->id);
+
+            while (!chain.empty() && !chain.back()->isAncestorOf(account->number)) {
+                chain.pop_back();
+            }
+            if (chain.empty()) {
+                top.push_back(account);
+            } else {
+                chain.back()->addChild(account);
+            }
+            chain.push_back(account);
+        });
+
+        // Reverse pre-order visits children before parents, so one pass over
+        // the parent and roll-up columns accumulates every subtree total. The
+        // adds wrap rather than throw: a partial sum over siblings may leave
+        // the range even though the subtree total, which postings checked,
+        // does not, and two's-complement wrapping still ends on that total.
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            uint32_t parentId = columns.parentIds[*it];
+            if (parentId != AccountColumns::NO_PARENT) {
+                Money::Rep& rollup = columns.rollups.mutate(parentId);
+                __builtin_add_overflow(rollup, columns.rollups[*it], &rollup);
+            }
+        }
+    };
+
+    roots.clear();
+    if (threads <= 1) {
+        linkSubtree("", roots);
+    } else {
+        columns.makeWritable();  // Tasks must never copy a page another task writes
+        const char digits[] = "0123456789";
+        vector<Account*> classRoots[10];
+        {
+            ThreadPool pool(threads);
+            vector<future<void>> linked;
+            for (int digit = 0; digit < 10; ++digit) {
+                linked.push_back(pool.submit([&, digit] {
+                    linkSubtree(string_view(digits + digit, 1), classRoots[digit]);
+                }));
+            }
+            for (future<void>& done : linked) {
+                done.get();
+            }
+        }
+        for (const vector<Account*>& top : classRoots) {
+            roots.insert(roots.end(), top.begin(), top.end());
+        }
+    }
+
+    hierarchyDirty = false;
+}
+
+// Inserts many pre-validated accounts (number, description) in order, on
+// threads threads. The trie paths are built first: lines are grouped by
+// their first two digits, and the nodes for the first digit are created here
+// up front, so every task is the only writer below the prefixes it takes.
+// New numbers then get consecutive ids in input order, so ids and duplicate
+// handling match calling insertAccount for each line, and the arena builds
+// the accounts in parallel before they are published. Returns the number
+// inserted.
+size_t ForestTree::insertAccounts(span<const pair<string_view, string_view>> batch, unsigned threads) {
+    unique_ptr<ThreadPool> pool;
+    if (threads > 1) {
+        pool = make_unique<ThreadPool>(threads);
+    }
+
+    vector<uint32_t> nodes(batch.size());
+    vector<vector<uint32_t>> groups(100);
+    AccountTrie::NodeBlock block;
+    bool firstDigits[10] = {};
+    for (uint32_t i = 0; i < batch.size(); ++i) {
+        string_view number = batch[i].first;
+        unsigned first = number[0] - '0';
+        if (!firstDigits[first]) {
+            firstDigits[first] = true;
+            accounts.emplacePath(number.substr(0, 1), block);
+        }
+        if (number.size() == 1) {
+            nodes[i] = accounts.emplacePath(number, block);
+        } else {
+            groups[first * 10 + (number[1] - '0')].push_back(i);
+        }
+    }
+
+    atomic<size_t> nextGroup(0);
+    auto buildPaths = [&] {
+        AccountTrie::NodeBlock own;
+        for (size_t group; (group = nextGroup.fetch_add(1, memory_order_relaxed)) < groups.size();) {
+            for (uint32_t i : groups[group]) {
+                nodes[i] = accounts.emplacePath(batch[i].first, own);
+            }
+        }
+    };
+    if (pool) {
+        vector<future<void>> built;
+        for (unsigned t = 0; t < threads; ++t) {
+            built.push_back(pool->submit(buildPaths));
+        }
+        for (future<void>& done : built) {
+            done.get();
+        }
+    } else {
+        buildPaths();
+    }
+
+    // Keep the first occurrence of each number that is not in the tree yet
+    const size_t PREFETCH_AHEAD = 16;  // Slots requested before they are needed
+    vector<uint8_t> taken(accounts.nodeBound());
+    vector<pair<string_view, string_view>> fresh;
+    vector<uint32_t> freshNodes;
+    fresh.reserve(batch.size());
+    freshNodes.reserve(batch.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (i + PREFETCH_AHEAD < batch.size()) {
+            accounts.prefetchSlot(nodes[i + PREFETCH_AHEAD]);
+        }
+        uint32_t node = nodes[i];
+        if (!taken[node] && accounts.accountAt(node) == nullptr) {
+            taken[node] = 1;
+            fresh.push_back(batch[i]);
+            freshNodes.push_back(node);
+        }
+    }
+    if (fresh.empty()) {
+        return 0;
+    }
+
+    uint32_t firstId = store.createRange(fresh, pool.get());
+    for (size_t k = 0; k < fresh.size(); ++k) {
+        if (k + PREFETCH_AHEAD < fresh.size()) {
+            accounts.prefetchSlot(freshNodes[k + PREFETCH_AHEAD]);
+        }
+        // Readers see each account fully built
+        accounts.claimSlot(freshNodes[k]).store(store.at(firstId + k), memory_order_release);
+    }
+    hierarchyDirty = true;
+    return fresh.size();
+}
+
+// Inserts an account whose number and description were already validated.
+// A single trie walk both detects duplicates and reserves the slot.
+Account* ForestTree::insertAccount(string_view number, string_view description) {
+    atomic<Account*>& slot = accounts.emplace(number);
+    if (slot.load(memory_order_relaxed) != nullptr) {
+        return nullptr;  // Account already exists
+    }
+
+    Account* newAccount = store.create(string(number), description);
+    slot.store(newAccount, memory_order_release);  // Readers see the account fully built
+    hierarchyDirty = true;  // Linked later by linkHierarchy()
+    return newAccount;
+}
+
+// Pre-sizes the trie so a bulk load does not reallocate repeatedly
+void ForestTree::reserveAccounts(size_t count) {
+    accounts.reserve(count);
+    store.reserve(count);
 }
 
 
 // Adds a transaction to a specific account by its account number
-void ForestTree::addTransaction(const string& accountNumber, double amount, char debitCredit) {
+void ForestTree::addTransaction(const string& accountNumber, Money amount, char debitCredit, int64_t timestamp) {
     if (!isValidAccountNumber(accountNumber)) {
         cout << "Error: Invalid account number. Must be numeric.\n";
         return;
@@ -104,38 +370,438 @@ void ForestTree::addTransaction(const string& accountNumber, double amount, char
         return;
     }
 
-    auto it = accounts.find(accountNumber);
-    if (it != accounts.end()) {
-        it->second->addTransaction(Transaction(accountNumber, amount, debitCredit));
+    Account* account = accounts.find(accountNumber);
+    if (account) {
+        if (timestamp == Transaction::NO_TIME) {
+            timestamp = Transaction::currentTime();
+        }
+        Transaction transaction(account->id, amount, debitCredit, timestamp);
+        if (!account->fitsChange(transaction.signedAmount(), amount, transaction.isCredit())) {
+            cout << "Error: Amount is out of range.\n";
+            return;
+        }
+        if (journal) {
+            journal->logPosting(accountNumber, amount, debitCredit, timestamp);
+        }
+        account->addTransaction(transaction);
     } else {
         cout << "Error: Account not found.\n";
     }
 }
 
-// Deletes a transaction from a specified account using the transaction index
-void ForestTree::deleteTransaction(const string& accountNumber, int index) {
+// Posts a batch of transactions. Each line is validated and resolved once,
+// then applyPostings appends them with one reservation and one balance
+// update per account and a single roll-up pass.
+PostingBatchResult ForestTree::postBatch(span<const Posting> postings) {
+    PostingBatchResult result;
+    if (hierarchyDirty) {
+        linkHierarchy();
+    }
+
+    // Validation pass: resolve every line to its account id once
+    vector<uint32_t> ids(postings.size());
+    for (size_t i = 0; i < postings.size(); ++i) {
+        ids[i] = resolvePosting(postings[i]);
+        if (ids[i] == AccountColumns::NO_PARENT) {
+            result.rejected.push_back(i);
+        }
+    }
+
+    result.posted = applyPostings(postings, ids, true, result.outOfRange);
+    if (!result.outOfRange.empty()) {
+        size_t invalid = result.rejected.size();
+        result.rejected.insert(result.rejected.end(), result.outOfRange.begin(), result.outOfRange.end());
+        inplace_merge(result.rejected.begin(), result.rejected.begin() + invalid, result.rejected.end());
+    }
+    return result;
+}
+
+// Posts a single balanced journal entry, or reports why it was refused and
+// posts nothing
+bool ForestTree::postEntry(const JournalEntry& entry) {
+    if (hierarchyDirty) {
+        linkHierarchy();
+    }
+    vector<Posting> lines;
+    vector<uint32_t> ids;
+    const char* problem = stageEntry(entry, Transaction::currentTime(), lines, ids);
+    if (problem) {
+        cout << "Error: " << problem << "\n";
+        return false;
+    }
+    if (!stagePostings(lines, ids)) {
+        cout << "Error: Amount is out of range.\n";
+        return false;
+    }
+    if (journal) {
+        journal->logEntry(lines, lines.front().timestamp);
+    }
+    commitPostings(lines, ids, false);
+    return true;
+}
+
+// Posts many journal entries. Every entry is checked as a whole first; the
+// lines of the accepted ones are then applied together, so accounts and
+// ancestors shared between entries are updated once for the whole run. If
+// that would take a total out of range, the entries are staged one at a
+// time instead and the ones that do not fit are refused whole.
+PostingBatchResult ForestTree::postEntries(span<const JournalEntry> entries) {
+    PostingBatchResult result;
+    if (hierarchyDirty) {
+        linkHierarchy();
+    }
+
+    size_t lineCount = 0;
+    for (const JournalEntry& entry : entries) {
+        lineCount += entry.lines.size();
+    }
+    vector<Posting> lines;
+    vector<uint32_t> ids;
+    lines.reserve(lineCount);
+    ids.reserve(lineCount);
+
+    const int64_t now = Transaction::currentTime();  // For entries without a timestamp
+    vector<size_t> staged;     // Accepted entries, in order
+    vector<size_t> firstLine;  // Where each accepted entry's lines start, then the end
+    for (size_t i = 0; i < entries.size(); ++i) {
+        size_t first = lines.size();
+        if (stageEntry(entries[i], now, lines, ids)) {
+            result.rejected.push_back(i);
+        } else {
+            staged.push_back(i);
+            firstLine.push_back(first);
+        }
+    }
+    firstLine.push_back(lines.size());
+
+    auto entryLines = [&](size_t k) {
+        return span<const Posting>(lines).subspan(firstLine[k], firstLine[k + 1] - firstLine[k]);
+    };
+    auto entryIds = [&](size_t k) {
+        return span<const uint32_t>(ids).subspan(firstLine[k], firstLine[k + 1] - firstLine[k]);
+    };
+    auto logEntry = [&](size_t k) {
+        if (journal) {
+            journal->logEntry(entryLines(k), lines[firstLine[k]].timestamp);
+        }
+    };
+
+    if (stagePostings(lines, ids)) {
+        for (size_t k = 0; k < staged.size(); ++k) {
+            logEntry(k);
+        }
+        commitPostings(lines, ids, false);
+        result.posted = staged.size();
+        return result;
+    }
+
+    for (size_t k = 0; k < staged.size(); ++k) {
+        if (stagePostings(entryLines(k), entryIds(k))) {
+            logEntry(k);
+            commitPostings(entryLines(k), entryIds(k), false);
+            ++result.posted;
+        } else {
+            result.rejected.push_back(staged[k]);
+            result.outOfRange.push_back(staged[k]);
+        }
+    }
+    sort(result.rejected.begin(), result.rejected.end());
+    return result;
+}
+
+// Checks an entry and, if it balances, appends its lines stamped with its
+// timestamp (or now) to lines and their account ids to ids. The caller
+// journals it as one record once its totals are known to fit. Returns why
+// the entry was refused, leaving both untouched.
+const char* ForestTree::stageEntry(const JournalEntry& entry, int64_t now, vector<Posting>& lines,
+                                   vector<uint32_t>& ids) {
+    size_t first = ids.size();
+    ids.resize(first + entry.lines.size());
+    if (const char* problem = checkEntry(entry, ids.data() + first)) {
+        ids.resize(first);
+        return problem;
+    }
+
+    int64_t timestamp = entry.timestamp == Transaction::NO_TIME ? now : entry.timestamp;
+    for (const Posting& line : entry.lines) {
+        lines.push_back(line);
+        lines.back().timestamp = timestamp;
+    }
+    return nullptr;
+}
+
+// Validates a posting's fields and finds its account; returns the account
+// id, or AccountColumns::NO_PARENT if the posting cannot be applied
+uint32_t ForestTree::resolvePosting(const Posting& posting) const {
+    if (isValidAccountNumber(posting.accountNumber) && isValidAmount(posting.amount) &&
+        isValidTransactionType(posting.debitCredit)) {
+        if (const Account* account = accounts.find(posting.accountNumber)) {
+            return account->id;
+        }
+    }
+    return AccountColumns::NO_PARENT;
+}
+
+// Resolves every line of an entry into ids and checks that it balances.
+// Returns why the entry cannot be posted, or nullptr if it can.
+const char* ForestTree::checkEntry(const JournalEntry& entry, uint32_t* ids) const {
+    if (entry.lines.size() < 2) {
+        return "A journal entry needs at least two lines.";
+    }
+    if (entry.lines.size() > JournalEntry::MAX_LINES) {
+        return "A journal entry has too many lines.";
+    }
+
+    Money debits, credits;
+    for (size_t i = 0; i < entry.lines.size(); ++i) {
+        const Posting& line = entry.lines[i];
+        ids[i] = resolvePosting(line);
+        if (ids[i] == AccountColumns::NO_PARENT) {
+            return "A journal entry line has an invalid or unknown account, amount or type.";
+        }
+        Money& total = line.debitCredit == 'C' ? credits : debits;
+        if (!total.canAdd(line.amount)) {
+            return "A journal entry total is out of range.";
+        }
+        total += line.amount;
+    }
+    if (debits != credits) {
+        return "The journal entry does not balance: total debits must equal total credits.";
+    }
+    if (debits.isZero()) {
+        return "The journal entry has no amount.";
+    }
+    return nullptr;
+}
+
+// Checks resolved postings (ids[i] is NO_PARENT for lines to skip) without
+// writing anything. Postings are grouped per account first, so every
+// account's debit and credit sums, balance and totals are checked once, and
+// the roll-ups of all touched accounts are planned in a single upward pass.
+// Returns true if every value stays in range; the update is then left in
+// the batch scratch space for commitPostings.
+bool ForestTree::stagePostings(span<const Posting> postings, span<const uint32_t> ids) {
+    const uint32_t NOT_FOUND = AccountColumns::NO_PARENT;
+    vector<uint32_t>& slotOf = batchSlots;  // Account id -> 1 + index in touched; all zero between batches
+    slotOf.resize(store.size(), 0);
+    vector<uint32_t> touched;  // Distinct account ids in first-seen order
+    batchPostings.clear();
+    batchDebits.clear();
+    batchCredits.clear();
+
+    bool fits = true;
+    for (size_t i = 0; i < postings.size(); ++i) {
+        uint32_t id = ids[i];
+        if (id == NOT_FOUND) {
+            continue;
+        }
+        if (slotOf[id] == 0) {
+            touched.push_back(id);
+            batchPostings.push_back(0);
+            batchDebits.push_back(0);
+            batchCredits.push_back(0);
+            slotOf[id] = static_cast<uint32_t>(touched.size());
+        }
+        size_t k = slotOf[id] - 1;
+        ++batchPostings[k];
+        Money::Rep& sum = (postings[i].debitCredit == 'C' ? batchCredits : batchDebits)[k];
+        fits &= !__builtin_add_overflow(sum, postings[i].amount.minorUnits(), &sum);
+    }
+
+    // One balance check per account; the sums are non-negative, so their
+    // difference cannot overflow
+    const AccountColumns& columns = store.columns;
+    batchDeltas.clear();
+    for (size_t k = 0; k < touched.size(); ++k) {
+        uint32_t id = touched[k];
+        slotOf[id] = 0;  // Restore the scratch array for the next batch
+        Money::Rep delta = batchDebits[k] - batchCredits[k];
+        Money::Rep checked;
+        fits &= !__builtin_add_overflow(columns.balances[id], delta, &checked) &&
+                !__builtin_add_overflow(columns.debitTotals[id], batchDebits[k], &checked) &&
+                !__builtin_add_overflow(columns.creditTotals[id], batchCredits[k], &checked);
+        batchDeltas.emplace_back(id, delta);
+    }
+
+    return fits && planRollups(batchDeltas);
+}
+
+// Appends the postings stagePostings accepted, reserving once per account,
+// then applies its balance and roll-up update. Every sum was checked when
+// the batch was staged, so nothing here can overflow. Returns the number
+// applied.
+size_t ForestTree::commitPostings(span<const Posting> postings, span<const uint32_t> ids, bool logEach) {
+    for (size_t k = 0; k < batchDeltas.size(); ++k) {
+        store.at(batchDeltas[k].first)->reserveTransactions(batchPostings[k]);
+    }
+
+    size_t posted = 0;
+    const int64_t now = Transaction::currentTime();  // For postings without a timestamp
+    for (size_t i = 0; i < postings.size(); ++i) {
+        if (ids[i] == AccountColumns::NO_PARENT) {
+            continue;
+        }
+        const Posting& posting = postings[i];
+        int64_t timestamp = posting.timestamp == Transaction::NO_TIME ? now : posting.timestamp;
+        Transaction transaction = Transaction::unchecked(ids[i], posting.amount, posting.debitCredit, timestamp);
+        if (logEach && journal) {
+            journal->logPosting(posting.accountNumber, posting.amount, posting.debitCredit, timestamp);
+        }
+        store.at(ids[i])->appendRecord(transaction);
+        ++posted;
+    }
+
+    // One balance update per account, one roll-up pass per batch
+    AccountColumns& columns = store.columns;
+    for (size_t k = 0; k < batchDeltas.size(); ++k) {
+        uint32_t id = batchDeltas[k].first;
+        columns.balances.mutate(id) += batchDeltas[k].second;
+        columns.debitTotals.mutate(id) += batchDebits[k];
+        columns.creditTotals.mutate(id) += batchCredits[k];
+    }
+    for (const auto& change : rollupPlan) {
+        columns.rollups.mutate(change.first) += change.second;
+    }
+    return posted;
+}
+
+// Applies resolved postings as one batch. When some total would overflow,
+// the postings are staged one at a time instead, so only those that do not
+// fit are refused and the ledger never holds a wrapped or partial update.
+size_t ForestTree::applyPostings(span<const Posting> postings, span<const uint32_t> ids, bool logEach,
+                                 vector<size_t>& outOfRange) {
+    if (stagePostings(postings, ids)) {
+        return commitPostings(postings, ids, logEach);
+    }
+
+    size_t posted = 0;
+    for (size_t i = 0; i < postings.size(); ++i) {
+        if (ids[i] == AccountColumns::NO_PARENT) {
+            continue;
+        }
+        if (postings.size() > 1 && stagePostings(postings.subspan(i, 1), ids.subspan(i, 1))) {
+            posted += commitPostings(postings.subspan(i, 1), ids.subspan(i, 1), logEach);
+        } else {
+            outOfRange.push_back(i);
+        }
+    }
+    return posted;
+}
+
+// Returns the length of an account number from the key column, falling back
+// to the Account object only for numbers of 16 digits or more
+size_t ForestTree::numberLength(uint32_t id) const {
+    uint64_t key = store.columns.numberKeys[id];
+    if ((key & 0xF) != 0) {
+        return store.at(id)->number.size();
+    }
+    return 16 - (__builtin_ctzll(key) >> 2);
+}
+
+// Plans the roll-up change of every account a batch reaches. Accounts are
+// processed deepest first (an ancestor's number is always shorter than its
+// descendants'), and each account's delta is merged into its parent's
+// pending carry before the parent is processed, so shared ancestors are
+// updated once per batch. Each change is checked against the roll-up it
+// will be added to; the column itself is not written. The scratch arrays are
+// left zeroed for next time.
+bool ForestTree::planRollups(const vector<pair<uint32_t, Money::Rep>>& deltas) {
+    const AccountColumns& columns = store.columns;
+    rollupCarry.resize(store.size());
+    rollupQueued.resize(store.size());
+    rollupPlan.clear();
+
+    bool fits = true;
+    vector<vector<uint32_t>>& byLength = rollupLevels;  // Queued account ids by number length; empty between calls
+    auto enqueue = [&](uint32_t id, Money::Rep amount) {
+        fits &= !__builtin_add_overflow(rollupCarry[id], amount, &rollupCarry[id]);
+        if (!rollupQueued[id]) {
+            rollupQueued[id] = 1;
+            size_t length = numberLength(id);
+            if (byLength.size() <= length) {
+                byLength.resize(length + 1);
+            }
+            byLength[length].push_back(id);
+        }
+    };
+
+    for (const auto& delta : deltas) {
+        enqueue(delta.first, delta.second);
+    }
+
+    for (size_t length = byLength.size(); length-- > 0;) {
+        for (uint32_t id : byLength[length]) {
+            Money::Rep amount = rollupCarry[id];
+            rollupCarry[id] = 0;
+            rollupQueued[id] = 0;
+            if (amount == 0) {
+                continue;
+            }
+
+            Money::Rep rollup;
+            fits &= !__builtin_add_overflow(columns.rollups[id], amount, &rollup);
+            rollupPlan.emplace_back(id, amount);
+            uint32_t parentId = columns.parentIds[id];
+            if (parentId != AccountColumns::NO_PARENT) {
+                enqueue(parentId, amount);
+            }
+        }
+        byLength[length].clear();
+    }
+    return fits;
+}
+
+// Deletes a transaction from a specified account using the transaction ID
+// shown in its account details. IDs never shift, so this is O(1 + depth).
+void ForestTree::deleteTransaction(const string& accountNumber, int id) {
     if (!isValidAccountNumber(accountNumber)) {
         cout << "Error: Invalid account number. Must be numeric.\n";
         return;
     }
 
-    auto it = accounts.find(accountNumber);
-    if (it != accounts.end()) {
-        // Call deleteTransaction in Account class
-        it->second->deleteTransaction(index); // The index is validated in Account
+    Account* account = accounts.find(accountNumber);
+    if (account) {
+        if (id < 0) {
+            cout << "Error: Invalid transaction ID.\n";
+            return;
+        }
+        // Call deleteTransaction in Account class; the ID is validated there
+        if (account->deleteTransaction(static_cast<uint32_t>(id))) {
+            if (journal) {
+                journal->logDeletion(accountNumber, static_cast<uint32_t>(id));
+            }
+            cout << "Transaction successfully deleted.\n"; // Confirmation message
+        }
     } else {
         cout << "Error: Account not found.\n";
     }
 }
 
+// Deletes a transaction by its stable 64-bit posting ID
+bool ForestTree::deletePosting(uint64_t postingId) {
+    Account* account = accountById(static_cast<uint32_t>(postingId >> 32));
+    if (account == nullptr) {
+        cout << "Error: Account not found.\n";
+        return false;
+    }
+    if (!account->deleteTransaction(static_cast<uint32_t>(postingId))) {
+        return false;
+    }
+    if (journal) {
+        journal->logDeletion(account->number, static_cast<uint32_t>(postingId));
+    }
+    return true;
+}
 
-
-// Searches for an account in the forest tree using its unique account number
-Account* ForestTree::searchAccount(const string& number) {
+// Searches for an account in the forest tree using its unique account number.
+// Lock-free and allocation-free, so any number of threads may search while
+// one thread adds accounts (see AccountTrie).
+Account* ForestTree::searchAccount(const string& number) const {
     // Trim account number before using it for searching
-    string trimmedNumber = number;
-    trimmedNumber.erase(0, trimmedNumber.find_first_not_of(" \t"));
-    trimmedNumber.erase(trimmedNumber.find_last_not_of(" \t") + 1);
+    string_view trimmedNumber = number;
+    size_t first = trimmedNumber.find_first_not_of(" \t");
+    trimmedNumber = first == string_view::npos ? string_view() : trimmedNumber.substr(first);
+    trimmedNumber = trimmedNumber.substr(0, trimmedNumber.find_last_not_of(" \t") + 1);
 
     // Validate that the account number is numeric
     if (!isValidAccountNumber(trimmedNumber)) {
@@ -143,13 +809,109 @@ Account* ForestTree::searchAccount(const string& number) {
         return nullptr;
     }
 
-    auto it = accounts.find(trimmedNumber);
-    if (it != accounts.end()) {
-        return it->second;
+    return accounts.find(trimmedNumber);
+}
+
+// Sums the own balances of every account whose number starts with prefix.
+// This reads only the number-key and balance columns in one branch-free loop
+// that the compiler can vectorize; the trie handles prefixes over 16 digits.
+Money ForestTree::sumBalances(const string& prefix) {
+    if (!isValidAccountNumber(prefix)) {
+        cout << "Error: Invalid account number. Must be numeric.\n";
+        return Money();
+    }
+
+    // Summed in Money::Wide, so only a total that does not fit is refused,
+    // whatever order the balances come in
+    Money::Wide total = 0;
+    bool overflowed = false;
+    auto add = [&](Money::Wide balance) {
+        overflowed |= !Money::addWide(total, balance);
+    };
+    if (prefix.size() > 16) {
+        accounts.forEachWithPrefix(prefix, [&](Account* account) {
+            add(account->balance().minorUnits());
+        });
+    } else {
+        const AccountColumns& columns = store.columns;
+        const uint64_t key = AccountArena::numberKey(prefix);
+        const uint64_t mask = ~0ull << (64 - 4 * prefix.size());
+        const uint64_t* keys = columns.numberKeys.data();
+
+        columns.balances.forEachRun([&](size_t first, const Money::Rep* balances, size_t count) {
+            const uint64_t* runKeys = keys + first;
+            for (size_t i = 0; i < count; ++i) {
+                add(((runKeys[i] & mask) == key) ? balances[i] : 0);
+            }
+        });
     }
 
-    
-    return nullptr;
+    Money sum;
+    if (overflowed || !Money::fromWide(total, sum)) {
+        cout << "Error: Amount is out of range.\n";
+        return Money();
+    }
+    return sum;
+}
+
+// Finds the account a time query is about, reporting why if there is none
+Account* ForestTree::findForQuery(const string& number) {
+    if (!isValidAccountNumber(number)) {
+        cout << "Error: Invalid account number. Must be numeric.\n";
+        return nullptr;
+    }
+    Account* account = accounts.find(number);
+    if (account == nullptr) {
+        cout << "Error: Account not found.\n";
+    }
+    return account;
+}
+
+// Adds up one time query over an account and its sub-accounts in
+// Money::Wide; reports an error and returns false if a member's result or
+// the total is out of range
+template <typename Query>
+bool ForestTree::sumSubtree(const Account* account, Money& total, Query query) {
+    Money::Wide sum = 0;
+    bool fits = true;
+    accounts.forEachWithPrefix(account->number, [&](Account* member) {
+        Money part;
+        fits = fits && query(member, part) && Money::addWide(sum, part.minorUnits());
+    });
+    if (!fits || !Money::fromWide(sum, total)) {
+        cout << "Error: Amount is out of range.\n";
+        return false;
+    }
+    return true;
+}
+
+// Balance of an account and its sub-accounts as it stood at time. Each
+// account answers from its own time index, so this is O(k log n) for k
+// accounts instead of a scan of every posting.
+bool ForestTree::balanceAsOf(const string& number, int64_t time, Money& balance) {
+    Account* account = findForQuery(number);
+    return account && sumSubtree(account, balance, [time](Account* member, Money& part) {
+        return member->balanceAsOf(time, part);
+    });
+}
+
+// Net movement of an account and its sub-accounts between two times,
+// both inclusive
+bool ForestTree::movementBetween(const string& number, int64_t from, int64_t to, Money& movement) {
+    Account* account = findForQuery(number);
+    return account && sumSubtree(account, movement, [from, to](Account* member, Money& part) {
+        return member->movementBetween(from, to, part);
+    });
+}
+
+// Returns every account whose number starts with prefix, in hierarchy order
+vector<Account*> ForestTree::findAccountsWithPrefix(const string& prefix) {
+    if (!isValidAccountNumber(prefix)) {
+        cout << "Error: Invalid account number. Must be numeric.\n";
+        return {};
+    }
+
+    return accounts.withPrefix(prefix);
 }
 
 
@@ -177,9 +939,9 @@ void ForestTree::printAccountDetails(const string& number, const string& filenam
     // Attempt to open the file for writing
     ofstream outFile(filename);
     if (outFile.is_open()) {
-        auto it = accounts.find(number);
-        if (it != accounts.end()) {
-            it->second->printDetails(outFile);
+        Account* account = accounts.find(number);
+        if (account) {
+            account->printDetails(outFile);
         } else {
             outFile << "Error: Account not found.\n";
         }
@@ -189,42 +951,150 @@ void ForestTree::printAccountDetails(const string& number, const string& filenam
     }
 }
 
-// Writes the hierarchical structure of the entire forest tree to a specified file
-void ForestTree::printForestTree(const string& filename) {
+// Writes the hierarchical structure of the entire forest tree to a specified file.
+// Each root (account class) is rendered as an independent task; with more
+// than one thread the classes render in parallel into their own buffers and
+// are written out in order as they complete.
+void ForestTree::printForestTree(const string& filename, const ReportOptions& options) {
     if (!isValidFilename(filename)) {
         cout << "Error: Invalid filename. Please avoid special characters and empty input.\n";
         return;
     }
 
+    if (hierarchyDirty) {
+        linkHierarchy();
+    }
+
+    unsigned threads = options.threads ? options.threads : thread::hardware_concurrency();
+    if (options.filePerClass) {
+        printClassFiles(filename, options, max(1u, threads));
+        return;
+    }
+
     ofstream outFile(filename);
-    if (outFile.is_open()) {
-        for (const auto& accountPair : accounts) {
-            if (accountPair.second->parent == nullptr) {
-                printAccountHierarchy(outFile, accountPair.second, 0);
+    if (!outFile.is_open()) {
+        cout << "Error: Could not open file \"" << filename << "\" for writing.\n";
+        return;
+    }
+
+    if (threads <= 1 || roots.size() < 2) {
+        ReportWriter writer(outFile);
+        for (Account* root : roots) {
+            printAccountHierarchy(writer, root, 0, options);
+        }
+        writer.flush();
+    } else {
+        ThreadPool pool(static_cast<unsigned>(min<size_t>(threads, roots.size())));
+        vector<future<string>> parts;
+        parts.reserve(roots.size());
+        for (Account* root : roots) {
+            parts.push_back(pool.submit([this, root, &options] {
+                string text;
+                ReportWriter writer(text);
+                printAccountHierarchy(writer, root, 0, options);
+                writer.flush();
+                return text;
+            }));
+        }
+        for (future<string>& part : parts) {
+            string text = part.get();
+            outFile.write(text.data(), static_cast<streamsize>(text.size()));
+        }
+    }
+    outFile.close();
+}
+
+// Writes each root's hierarchy to its own file, "<stem>_<number><extension>",
+// rendering and writing the files in parallel
+void ForestTree::printClassFiles(const string& filename, const ReportOptions& options, unsigned threads) {
+    filesystem::path base(filename);
+    ThreadPool pool(static_cast<unsigned>(min<size_t>(threads, max<size_t>(roots.size(), 1))));
+    vector<pair<string, future<bool>>> files;
+    files.reserve(roots.size());
+    for (Account* root : roots) {
+        string classFile = base.stem().string() + "_" + root->number + base.extension().string();
+        files.emplace_back(classFile, pool.submit([this, root, classFile, &options] {
+            ofstream outFile(classFile);
+            if (!outFile.is_open()) {
+                return false;
             }
+            ReportWriter writer(outFile);
+            printAccountHierarchy(writer, root, 0, options);
+            writer.flush();
+            return static_cast<bool>(outFile);
+        }));
+    }
+    for (auto& [classFile, written] : files) {
+        if (!written.get()) {
+            cout << "Error: Could not open file \"" << classFile << "\" for writing.\n";
         }
+    }
+}
+
+// Writes the trial balance of the whole forest
+void ForestTree::printTrialBalance(const string& filename, const FinancialReportOptions& options) {
+    printFinancialReport(filename, options, &FinancialReports::writeTrialBalance);
+}
+
+// Writes the balance sheet (classes 1-5)
+void ForestTree::printBalanceSheet(const string& filename, const FinancialReportOptions& options) {
+    printFinancialReport(filename, options, &FinancialReports::writeBalanceSheet);
+}
+
+// Writes the income statement (classes 6-7)
+void ForestTree::printIncomeStatement(const string& filename, const FinancialReportOptions& options) {
+    printFinancialReport(filename, options, &FinancialReports::writeIncomeStatement);
+}
+
+// Freezes the hierarchy and balances. Linking first makes the frozen parent
+// and roll-up columns complete; the freeze itself only shares page tables.
+FrozenLedger ForestTree::freeze() {
+    if (hierarchyDirty) {
+        linkHierarchy();
+    }
+    return FrozenLedger(*this, store.columns, Transaction::currentTime());
+}
+
+// Validates the filename, aggregates the forest once and writes one report
+void ForestTree::printFinancialReport(const string& filename, const FinancialReportOptions& options,
+                                      void (FinancialReports::*write)(ReportWriter&, const FinancialReportOptions&) const) {
+    if (!isValidFilename(filename)) {
+        cout << "Error: Invalid filename. Please avoid special characters and empty input.\n";
+        return;
+    }
+
+    if (hierarchyDirty) {
+        linkHierarchy();
+    }
+
+    ofstream outFile(filename);
+    if (outFile.is_open()) {
+        FinancialReports reports(*this);
+        ReportWriter writer(outFile);
+        (reports.*write)(writer, options);
+        writer.flush();
         outFile.close();
     } else {
         cout << "Error: Could not open file \"" << filename << "\" for writing.\n";
     }
 }
 
-// Helper function to recursively write the account hierarchy
-void ForestTree::printAccountHierarchy(ostream& os, Account* account, int level) {
+// Helper function to write one account's hierarchy
+void ForestTree::printAccountHierarchy(ReportWriter& writer, Account* account, int level, const ReportOptions& options) {
     if (account) {
-        account->printHierarchy(os, level);
+        writer.writeHierarchy(account, level, options);
     }
 }
 
 // Validates that the account number contains only numeric characters
-bool ForestTree::isValidAccountNumber(const string& accountNumber) const {
+bool ForestTree::isValidAccountNumber(string_view accountNumber) const {
     return !accountNumber.empty() && all_of(accountNumber.begin(), accountNumber.end(), ::isdigit);
 }
 
 
 // Validates that the transaction amount is non-negative
-bool ForestTree::isValidAmount(double amount)const {
-    return amount >= 0;
+bool ForestTree::isValidAmount(Money amount)const {
+    return !amount.isNegative();
 }
 
 // Validates that the transaction type is either 'D' (Debit) or 'C' (Credit)
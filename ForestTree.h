@@ -9,73 +9,274 @@
  * Date: 26/11/2024
  *
  * Fields:
- *  - unordered_map<string, Account*> accounts: Stores all accounts by their
- *    unique account numbers.
+ *  - AccountTrie accounts: Digit trie indexing all accounts by their unique
+ *    account numbers. Supports exact, ancestor and prefix lookups.
+ *  - vector<Account*> roots: Accounts that have no ancestor in the forest,
+ *    kept in number order like every children list, so reports walk the
+ *    forest in order without sorting.
+ *  - AccountArena store: Owns every account, indexed by the dense id that
+ *    each Transaction record stores. Hot fields (number keys, parent ids,
+ *    balances, description offsets) are kept in its parallel columns.
+ *  - bool hierarchyDirty: Set by bulk inserts until linkHierarchy() runs.
+ *  - Journal* journal: Optional write-ahead journal; every accepted change is
+ *    logged to it before the call returns.
  *
  * Functions:
  *  - ForestTree(): Constructor to initialize an empty forest tree.
- *  - ~ForestTree(): Destructor to clean up dynamically allocated memory.
+ *  - ~ForestTree(): Destructor; the arena frees every account in one sweep.
  *  - void addAccount(const string& number, const string& description):
  *      Adds a new account to the forest tree.
- *  - void addTransaction(const string& accountNumber, double amount,
- *                        char debitCredit):
+ *  - Account* insertAccount(string_view number, string_view description):
+ *      Bulk-load fast path: inserts an already validated, trimmed account.
+ *      Returns nullptr without printing if the number already exists.
+ *  - size_t insertAccounts(span<const pair<string_view, string_view>> batch,
+ *                          unsigned threads):
+ *      Inserts many validated, trimmed (number, description) pairs as
+ *      insertAccount would, building the trie paths on threads threads
+ *      first. Returns how many were new.
+ *  - void linkHierarchy(unsigned threads):
+ *      Rebuilds parent/child links from the numbering scheme (1 -> 10 -> 101)
+ *      with one ordered walk of the trie, split by leading digit over
+ *      threads threads when more than one is given.
+ *  - void attachJournal(Journal* journal):
+ *      Logs every later addAccount, posting and deletion to journal (nullptr
+ *      to stop). Bulk inserts through insertAccount are not journaled.
+ *  - void reserveAccounts(size_t count):
+ *      Pre-sizes the account table ahead of a bulk load.
+ *  - void addTransaction(const string& accountNumber, Money amount,
+ *                        char debitCredit, int64_t timestamp):
  *      Adds a transaction to an account and updates balances up the hierarchy.
- *  - void deleteTransaction(const string& accountNumber, int index):
- *      Deletes a transaction from an account by its index.
- *  - Account* searchAccount(const string& number):
- *      Searches for and returns an account by its number.
+ *      The posting is stamped with the current time unless timestamp is given.
+ *      A posting that would take a balance, total or roll-up out of Money's
+ *      range is refused before anything is journaled or changed.
+ *  - PostingBatchResult postBatch(span<const Posting> postings):
+ *      Validates a whole batch in one pass, groups it by account, appends
+ *      each account's postings with one reservation and propagates roll-ups
+ *      once per batch. Invalid lines are skipped and reported by index, as
+ *      are lines that would take a balance or roll-up out of Money's range.
+ *  - bool postEntry(const JournalEntry& entry):
+ *      Posts a double-entry journal entry: every line must be valid and the
+ *      debits must equal the credits, or nothing is posted and the reason is
+ *      printed (including when a total would leave Money's range). The entry
+ *      is journaled as one record, so it is never replayed half-applied.
+ *  - PostingBatchResult postEntries(span<const JournalEntry> entries):
+ *      Posts many entries (e.g. a payroll run) with a single roll-up pass.
+ *      posted counts whole entries; rejected lists the entries refused.
+ *  - void deleteTransaction(const string& accountNumber, int id):
+ *      Deletes a transaction from an account by its transaction ID (the
+ *      per-account sequence number shown in the account details).
+ *  - bool deletePosting(uint64_t postingId):
+ *      Deletes a transaction by its stable 64-bit posting ID.
+ *  - Account* searchAccount(const string& number) const:
+ *      Searches for and returns an account by its number. Safe to call from
+ *      many threads while one thread adds accounts: lookups take no lock
+ *      and see each new account either fully linked into the trie or not
+ *      at all. Only the returned account's number and id are safe to read
+ *      during such writes.
+ *  - Money sumBalances(const string& prefix):
+ *      Sums the balances of every account under prefix with a column scan.
+ *      Reports an error and returns zero if the total is out of range.
+ *  - bool balanceAsOf(const string& number, int64_t time, Money& balance):
+ *      The account's balance including sub-accounts, counting only postings
+ *      at or before time. O(log n) per account through their time indexes.
+ *  - bool movementBetween(const string& number, int64_t from, int64_t to,
+ *                         Money& movement):
+ *      Net movement of the account and its sub-accounts from from to to.
+ *    Both report an error and return false for an unknown account or a
+ *    total out of range.
+ *  - Account* accountById(uint32_t id):
+ *      Resolves the account ID stored in a Transaction.
+ *  - vector<Account*> findAccountsWithPrefix(const string& prefix):
+ *      Returns every account whose number starts with prefix (e.g. "60" for
+ *      all of 60*) in hierarchy order, in O(prefix + results).
  *  - void printAccountDetails(const string& number, const string& filename):
  *      Writes the details of a specific account to a file.
- *  - void printForestTree(const string& filename):
- *      Writes the hierarchical structure of the forest tree to a file.
+ *  - void printForestTree(const string& filename, const ReportOptions& options):
+ *      Writes the hierarchical structure of the forest tree to a file through
+ *      a ReportWriter, optionally limited in depth or without postings. Root
+ *      classes are rendered in parallel and concatenated in order, or written
+ *      to one file per class with options.filePerClass.
+ *  - void printTrialBalance / printBalanceSheet / printIncomeStatement(
+ *        const string& filename, const FinancialReportOptions& options):
+ *      Write a financial report (text or CSV) computed by FinancialReports in
+ *      one pass over the debit and credit total columns.
+ *  - FrozenLedger freeze():
+ *      Freezes the hierarchy and balances in O(1), e.g. at a period close.
+ *      Reports can then be run from the FrozenLedger while posting goes on;
+ *      later writes copy only the column pages they touch.
  */
 
 #ifndef FOREST_TREE_H
 #define FOREST_TREE_H
 
-#include <unordered_map>
 #include <string>
+#include <vector>
+#include <string_view>
+#include <span>
 #include <ostream>
 #include "Account.h"
+#include "AccountTrie.h"
+#include "AccountArena.h"
+#include "Journal.h"
+#include "ReportWriter.h"
+#include "FinancialReports.h"
+#include "FrozenLedger.h"
 
 using namespace std;
 
+/**
+ * Struct: PostingBatchResult
+ * Purpose: Outcome of ForestTree::postBatch and ForestTree::postEntries.
+ */
+struct PostingBatchResult {
+    size_t posted = 0;             // Postings (or, from postEntries, entries) applied
+    vector<size_t> rejected;       // Indices of postings or entries that failed validation
+    vector<size_t> outOfRange;     // The rejected ones refused because a total would overflow
+};
+
 /**
  * Class: ForestTree
  * Purpose: Manages a hierarchical structure of accounts, supporting operations
  *          like adding accounts, managing transactions, and generating reports.
  */
 class ForestTree {
+    friend class PostingEngine;  // Applies postings directly to the columns
+    friend class Journal;        // Replays records without logging them again
+    friend class Snapshot;       // Saves and restores the arena in bulk
+    friend class FinancialReports;  // Aggregates the debit and credit columns
+    friend class FrozenLedger;      // Reads the trie of a frozen period
+
 private:
-    // Stores all accounts by their unique account numbers
-    unordered_map<string, Account*> accounts;
+    // Indexes all accounts by their unique account numbers
+    AccountTrie accounts;
+
+    // Accounts without an ancestor, i.e. the roots of the forest, in number order
+    vector<Account*> roots;
+
+    // Owns every account; ids are assigned in insertion order
+    AccountArena store;
+
+    // True when bulk inserts have not been linked into the hierarchy yet
+    bool hierarchyDirty;
+
+    // Receives every accepted change, or nullptr
+    Journal* journal;
+
+    // Links one new account under its nearest ancestor and adopts its descendants
+    void linkAccount(Account* account);
+
+    // Works out the roll-up change of each (account id, amount) and of its
+    // ancestors into rollupPlan, visiting every shared ancestor once; returns
+    // false if a roll-up would leave Money's range
+    bool planRollups(const vector<pair<uint32_t, Money::Rep>>& deltas);
+
+    // True if the new account number's roll-up, the sum of the subtrees it
+    // would adopt, is in range
+    bool adoptionFits(string_view number) const;
+
+    // Validates a posting and returns its account id, or AccountColumns::NO_PARENT
+    uint32_t resolvePosting(const Posting& posting) const;
+
+    // Finds the account of a time query, or reports why there is none
+    Account* findForQuery(const string& number);
 
-    // Helper function to recursively print the account hierarchy
-    void printAccountHierarchy(ostream& os, Account* account, int level);
+    // Sums a time query over an account's subtree; false if out of range
+    template <typename Query>
+    bool sumSubtree(const Account* account, Money& total, Query query);
+
+    // Resolves an entry's lines into ids; returns why it cannot be posted, or nullptr
+    const char* checkEntry(const JournalEntry& entry, uint32_t* ids) const;
+
+    // Checks an entry and queues its stamped lines and ids for stagePostings;
+    // returns why it was refused, or nullptr
+    const char* stageEntry(const JournalEntry& entry, int64_t now, vector<Posting>& lines, vector<uint32_t>& ids);
+
+    // Checks postings whose ids are resolved (NO_PARENT skips a line) against
+    // every balance, total and roll-up they change, writing nothing; true if
+    // all stay in range, with the update left in the batch scratch space
+    bool stagePostings(span<const Posting> postings, span<const uint32_t> ids);
+
+    // Appends the postings stagePostings accepted and applies its update;
+    // logEach journals every posting on its own
+    size_t commitPostings(span<const Posting> postings, span<const uint32_t> ids, bool logEach);
+
+    // Stages and commits postings with one roll-up pass. If a total would
+    // overflow, posts them one at a time instead and adds the indices that
+    // do not fit to outOfRange
+    size_t applyPostings(span<const Posting> postings, span<const uint32_t> ids, bool logEach,
+                         vector<size_t>& outOfRange);
+
+    // Number of digits in an account's number, read from the key column
+    size_t numberLength(uint32_t id) const;
+
+    // Per-account scratch space for batch posting, kept zeroed between calls
+    vector<uint32_t> batchSlots;
+    vector<Money::Rep> rollupCarry;
+    vector<uint8_t> rollupQueued;
+    vector<vector<uint32_t>> rollupLevels;
+
+    // The update of the last staged batch, one entry per touched account
+    vector<uint32_t> batchPostings;                    // Postings per account
+    vector<Money::Rep> batchDebits, batchCredits;      // Debit and credit sums per account
+    vector<pair<uint32_t, Money::Rep>> batchDeltas;    // (account id, balance change)
+    vector<pair<uint32_t, Money::Rep>> rollupPlan;     // (account id, roll-up change)
+
+
+    // Writes each root's hierarchy to its own file on a thread pool
+    void printClassFiles(const string& filename, const ReportOptions& options, unsigned threads);
+
+    // Runs the aggregation pass and writes one financial report to filename
+    void printFinancialReport(const string& filename, const FinancialReportOptions& options,
+                              void (FinancialReports::*write)(ReportWriter&, const FinancialReportOptions&) const);
+
+    // Helper function to write one account's hierarchy
+    void printAccountHierarchy(ReportWriter& writer, Account* account, int level, const ReportOptions& options);
 
     // Validation utility functions
     // Validate numeric account number
-    bool isValidAmount(double amount) const;                     // Validate non-negative amounts
+    bool isValidAmount(Money amount) const;                      // Validate non-negative amounts
     bool isValidTransactionType(char debitCredit) const;         // Validate 'D' or 'C'
     bool isValidFilename(const string& filename) const;          // Validate valid filenames
 
 public:
- bool isValidAccountNumber(const string& accountNumber) const;
+ bool isValidAccountNumber(string_view accountNumber) const;
     // Constructor and Destructor
     ForestTree();  // Initializes an empty forest tree
     ~ForestTree(); // Cleans up dynamically allocated memory
 
     // Account and Transaction Management
     void addAccount(const string& number, const string& description);  // Adds a new account
-    void addTransaction(const string& accountNumber, double amount, char debitCredit);  // Adds a transaction
-    void deleteTransaction(const string& accountNumber, int index);  // Deletes a transaction by index
+    Account* insertAccount(string_view number, string_view description);  // Inserts a pre-validated account
+    void attachJournal(Journal* journal) { this->journal = journal; }  // Logs later changes to journal
+    void reserveAccounts(size_t count);  // Pre-sizes the account table for bulk loads
+    size_t size() const { return accounts.size(); }  // Number of accounts in the forest
+    size_t insertAccounts(span<const pair<string_view, string_view>> batch, unsigned threads);  // Bulk insert
+    void linkHierarchy(unsigned threads = 1);  // Rebuilds parent/child links from account-number prefixes
+    void addTransaction(const string& accountNumber, Money amount, char debitCredit,
+                        int64_t timestamp = Transaction::NO_TIME);  // Adds a transaction
+    PostingBatchResult postBatch(span<const Posting> postings);  // Posts many transactions at once
+    bool postEntry(const JournalEntry& entry);  // Posts one balanced journal entry atomically
+    PostingBatchResult postEntries(span<const JournalEntry> entries);  // Posts many journal entries
+    void deleteTransaction(const string& accountNumber, int id);  // Deletes a transaction by ID
+    bool deletePosting(uint64_t postingId);  // Deletes a transaction by its stable posting ID
 
     // Account Search
-    Account* searchAccount(const string& number);  // Searches for an account by its number
+    Account* searchAccount(const string& number) const;  // Searches for an account by its number (lock-free)
+    vector<Account*> findAccountsWithPrefix(const string& prefix);  // Lists all accounts under a prefix
+    Money sumBalances(const string& prefix);  // Sums all balances under a prefix with a column scan
+    bool balanceAsOf(const string& number, int64_t time, Money& balance);  // Roll-up balance at a point in time
+    bool movementBetween(const string& number, int64_t from, int64_t to, Money& movement);  // Roll-up movement over a period
+    Account* accountById(uint32_t id) const { return id < store.size() ? store.at(id) : nullptr; }  // Resolves a transaction's account
 
     // Reporting
     void printAccountDetails(const string& number, const string& filename);  // Prints account details to a file
-    void printForestTree(const string& filename);  // Prints the entire forest tree structure to a file
+    void printForestTree(const string& filename, const ReportOptions& options = ReportOptions());  // Prints the entire forest tree structure to a file
+    void printTrialBalance(const string& filename, const FinancialReportOptions& options = FinancialReportOptions());  // Debits, credits and balances
+    void printBalanceSheet(const string& filename, const FinancialReportOptions& options = FinancialReportOptions());  // Classes 1-5
+    void printIncomeStatement(const string& filename, const FinancialReportOptions& options = FinancialReportOptions());  // Classes 6-7
+
+    // Period close
+    FrozenLedger freeze();  // O(1) copy-on-write snapshot of the hierarchy and balances
 };
 
 #endif
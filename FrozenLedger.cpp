@@ -0,0 +1,70 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: FrozenLedger.cpp
+ * Purpose: Implements freezing the account columns and reporting from them.
+ */
+
+#include "FrozenLedger.h"
+#include "ForestTree.h"
+#include "ReportWriter.h"
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+// Shares every column's pages with the ledger: O(1) per column
+FrozenLedger::FrozenLedger(const ForestTree& tree, AccountColumns& columns, int64_t closedAt)
+    : tree(&tree), count(static_cast<uint32_t>(columns.balances.size())), closedAt(closedAt),
+      parentIds(columns.parentIds.freeze()), balances(columns.balances.freeze()),
+      rollups(columns.rollups.freeze()), debitTotals(columns.debitTotals.freeze()),
+      creditTotals(columns.creditTotals.freeze()) {}
+
+// Looks the number up in the live trie; accounts added later are not part
+// of this ledger
+const Account* FrozenLedger::find(string_view number) const {
+    if (tree == nullptr) {
+        return nullptr;
+    }
+    const Account* account = tree->accounts.find(number);
+    return account && account->id < count ? account : nullptr;
+}
+
+// Writes the trial balance as of the freeze
+void FrozenLedger::printTrialBalance(const string& filename, const FinancialReportOptions& options) const {
+    printFinancialReport(filename, options, &FinancialReports::writeTrialBalance);
+}
+
+// Writes the balance sheet (classes 1-5) as of the freeze
+void FrozenLedger::printBalanceSheet(const string& filename, const FinancialReportOptions& options) const {
+    printFinancialReport(filename, options, &FinancialReports::writeBalanceSheet);
+}
+
+// Writes the income statement (classes 6-7) as of the freeze
+void FrozenLedger::printIncomeStatement(const string& filename, const FinancialReportOptions& options) const {
+    printFinancialReport(filename, options, &FinancialReports::writeIncomeStatement);
+}
+
+// Same validation and output as ForestTree's reports, over the frozen columns
+void FrozenLedger::printFinancialReport(const string& filename, const FinancialReportOptions& options,
+                                        void (FinancialReports::*write)(ReportWriter&, const FinancialReportOptions&) const) const {
+    if (tree == nullptr) {
+        cout << "Error: The ledger was never frozen.\n";
+        return;
+    }
+    if (!tree->isValidFilename(filename)) {
+        cout << "Error: Invalid filename. Please avoid special characters and empty input.\n";
+        return;
+    }
+
+    ofstream outFile(filename);
+    if (outFile.is_open()) {
+        FinancialReports reports(*this);
+        ReportWriter writer(outFile);
+        (reports.*write)(writer, options);
+        writer.flush();
+        outFile.close();
+    } else {
+        cout << "Error: Could not open file \"" << filename << "\" for writing.\n";
+    }
+}
@@ -0,0 +1,98 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: FrozenLedger.h
+ * Purpose: Defines the FrozenLedger class, a read-only view of a ForestTree's
+ *          accounts and balances at one moment (e.g. a period close), taken
+ *          in O(1) with copy-on-write columns.
+ *
+ * Fields:
+ *  - const ForestTree* tree: The live tree, used for the account numbers,
+ *    descriptions and the trie, none of which change when posting.
+ *  - uint32_t count: Accounts that existed when the ledger was frozen.
+ *  - int64_t closedAt: When it was frozen (see Transaction::currentTime).
+ *  - CowColumn<...>::Frozen parentIds, balances, rollups, debitTotals,
+ *    creditTotals: The hierarchy and balance columns as they were.
+ *
+ * Functions:
+ *  - size_t size() const / int64_t closedTime() const:
+ *      Accounts in the ledger and when it was frozen.
+ *  - const Account* find(string_view number) const:
+ *      Looks up an account that existed at the freeze, or returns nullptr.
+ *  - Money balance / rollupBalance / debitTotal / creditTotal(uint32_t id) const:
+ *      An account's frozen values.
+ *  - uint32_t parentId(uint32_t id) const:
+ *      The account's parent at the freeze, or AccountColumns::NO_PARENT.
+ *  - void printTrialBalance / printBalanceSheet / printIncomeStatement(
+ *        const string& filename, const FinancialReportOptions& options) const:
+ *      Write the financial reports from the frozen values.
+ *
+ * Created by ForestTree::freeze(). Writers may keep posting to and deleting
+ * postings from the tree while other threads read a FrozenLedger, as every
+ * page they write is copied first. Adding accounts must wait until no
+ * reader is running (the trie and description pool are shared), and the
+ * ledger must not outlive its tree.
+ */
+
+#ifndef FROZEN_LEDGER_H
+#define FROZEN_LEDGER_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include "Money.h"
+#include "CowColumn.h"
+#include "FinancialReports.h"
+
+using namespace std;
+
+class Account;
+class ForestTree;
+struct AccountColumns;
+
+/**
+ * Class: FrozenLedger
+ * Purpose: Point-in-time snapshot of the account columns for reporting.
+ */
+class FrozenLedger {
+    friend class ForestTree;        // Creates ledgers
+    friend class FinancialReports;  // Aggregates the frozen columns
+
+private:
+    const ForestTree* tree;
+    uint32_t count;
+    int64_t closedAt;
+    CowColumn<uint32_t>::Frozen parentIds;
+    CowColumn<Money::Rep>::Frozen balances;
+    CowColumn<Money::Rep>::Frozen rollups;
+    CowColumn<Money::Rep>::Frozen debitTotals;
+    CowColumn<Money::Rep>::Frozen creditTotals;
+
+    // Freezes columns, which belong to tree
+    FrozenLedger(const ForestTree& tree, AccountColumns& columns, int64_t closedAt);
+
+    // Validates the filename, aggregates once and writes one report
+    void printFinancialReport(const string& filename, const FinancialReportOptions& options,
+                              void (FinancialReports::*write)(ReportWriter&, const FinancialReportOptions&) const) const;
+
+public:
+    FrozenLedger() : tree(nullptr), count(0), closedAt(0) {}
+
+    size_t size() const { return count; }
+    int64_t closedTime() const { return closedAt; }
+
+    const Account* find(string_view number) const;  // Account that existed at the freeze
+
+    Money balance(uint32_t id) const { return Money::fromMinor(balances[id]); }
+    Money rollupBalance(uint32_t id) const { return Money::fromMinor(rollups[id]); }
+    Money debitTotal(uint32_t id) const { return Money::fromMinor(debitTotals[id]); }
+    Money creditTotal(uint32_t id) const { return Money::fromMinor(creditTotals[id]); }
+    uint32_t parentId(uint32_t id) const { return parentIds[id]; }
+
+    void printTrialBalance(const string& filename, const FinancialReportOptions& options = FinancialReportOptions()) const;
+    void printBalanceSheet(const string& filename, const FinancialReportOptions& options = FinancialReportOptions()) const;
+    void printIncomeStatement(const string& filename, const FinancialReportOptions& options = FinancialReportOptions()) const;
+};
+
+#endif
@@ -0,0 +1,542 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: Journal.cpp
+ * Purpose: Implements the Journal class: record framing, group commit on a
+ *          background thread, torn-tail recovery and replay into a ForestTree.
+ */
+
+#include "Journal.h"
+#include "ForestTree.h"
+#include "MappedFile.h"
+#include "Checksum.h"
+#include <iostream>
+#include <cstring>
+#include <vector>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+const char MAGIC[8] = {'C', 'O', 'A', 'J', 'R', 'N', 'L', '\0'};
+const size_t REPLAY_BATCH = 65536;  // Postings handed to postBatch (or entry lines to postEntries) at a time
+
+// Appends the raw bytes of a trivially copyable value
+template <typename T>
+void put(string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Appends a uint16 length followed by the account number
+void putNumber(string& out, string_view number) {
+    put(out, static_cast<uint16_t>(number.size()));
+    out.append(number);
+}
+
+// Reads a value at offset, advancing it; false if the payload is too short
+template <typename T>
+bool get(string_view payload, size_t& offset, T& value) {
+    if (payload.size() - offset < sizeof(T)) {
+        return false;
+    }
+    memcpy(&value, payload.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+// Reads a length-prefixed string of the given length type
+template <typename Length>
+bool getText(string_view payload, size_t& offset, string_view& text) {
+    Length length;
+    if (!get(payload, offset, length) || payload.size() - offset < length) {
+        return false;
+    }
+    text = payload.substr(offset, length);
+    offset += length;
+    return true;
+}
+
+// Reads an ENTRY payload, adding its lines to lines, its timestamp to
+// entries and its line count to sizes
+bool readEntry(string_view payload, vector<Posting>& lines, vector<JournalEntry>& entries,
+               vector<uint16_t>& sizes) {
+    size_t cursor = 0;
+    int64_t timestamp;
+    uint16_t count;
+    if (!get(payload, cursor, timestamp) || !get(payload, cursor, count)) {
+        return false;
+    }
+    size_t first = lines.size();
+    for (uint16_t i = 0; i < count; ++i) {
+        string_view number;
+        Money::Rep minor;
+        char debitCredit;
+        if (!getText<uint16_t>(payload, cursor, number) || !get(payload, cursor, minor) ||
+            !get(payload, cursor, debitCredit)) {
+            lines.resize(first);
+            return false;
+        }
+        lines.push_back(Posting{number, Money::fromMinor(minor), debitCredit, timestamp});
+    }
+    entries.push_back(JournalEntry{{}, timestamp});
+    sizes.push_back(count);
+    return true;
+}
+
+// Flushes the C library buffer and asks the OS to put the data on disk
+bool syncFile(FILE* file) {
+    if (fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Cuts the file back to length, e.g. to drop a half-written group
+bool truncateFile(FILE* file, long length) {
+#ifdef _WIN32
+    bool cut = _chsize_s(_fileno(file), length) == 0;
+#else
+    bool cut = ftruncate(fileno(file), length) == 0;
+#endif
+    return cut && fseek(file, length, SEEK_SET) == 0;
+}
+
+} // namespace
+
+// Constructor: Closed journal with a 5 ms / 1 MB group commit
+Journal::Journal()
+    : file(nullptr), durability(Durability::AsyncGroupCommit), interval(5), groupBytes(1 << 20),
+      stopping(false), failing(false) {}
+
+// Destructor: Commits whatever is still buffered
+Journal::~Journal() {
+    close();
+}
+
+// Returns the length of the header plus every intact record. A record is
+// intact if it fits in the file and its checksum matches.
+size_t Journal::validLength(string_view contents, bool& tornTail) {
+    tornTail = false;
+    if (contents.size() < HEADER_SIZE || memcmp(contents.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        return 0;
+    }
+    uint32_t version, repSize;
+    memcpy(&version, contents.data() + 8, 4);
+    memcpy(&repSize, contents.data() + 12, 4);
+    if (version != VERSION || repSize != sizeof(Money::Rep)) {
+        return 0;
+    }
+
+    size_t offset = HEADER_SIZE;
+    while (offset < contents.size()) {
+        uint32_t length, crc;
+        if (contents.size() - offset < RECORD_HEADER_SIZE) {
+            break;
+        }
+        memcpy(&length, contents.data() + offset, 4);
+        memcpy(&crc, contents.data() + offset + 4, 4);
+        if (contents.size() - offset - RECORD_HEADER_SIZE < length ||
+            crc32(contents.data() + offset + 8, length + 1) != crc) {
+            break;
+        }
+        offset += RECORD_HEADER_SIZE + length;
+    }
+    tornTail = offset != contents.size();
+    return offset;
+}
+
+// Opens filename for appending, creating it with a header if it is new and
+// cutting off a torn record left by a crash
+bool Journal::open(const string& filename, Durability mode) {
+    close();
+
+    error_code error;
+    uintmax_t existing = filesystem::exists(filename, error) ? filesystem::file_size(filename, error) : 0;
+    if (existing > 0) {
+        MappedFile mapped;
+        if (!mapped.open(filename)) {
+            cout << "Error: Could not open journal \"" << filename << "\".\n";
+            return false;
+        }
+        bool tornTail;
+        size_t valid = validLength(mapped.contents(), tornTail);
+        mapped.close();
+        if (valid == 0) {
+            cout << "Error: \"" << filename << "\" is not a journal of this version.\n";
+            return false;
+        }
+        if (tornTail) {
+            filesystem::resize_file(filename, valid, error);
+            if (error) {
+                cout << "Error: Could not truncate journal \"" << filename << "\".\n";
+                return false;
+            }
+        }
+    }
+
+    file = fopen(filename.c_str(), existing > 0 ? "ab" : "wb");
+    if (file == nullptr) {
+        cout << "Error: Could not open journal \"" << filename << "\" for writing.\n";
+        return false;
+    }
+    setvbuf(file, nullptr, _IONBF, 0);  // Records are buffered here; a failed write leaves nothing behind in stdio
+
+    durability = mode;
+    if (existing == 0) {
+        string header(MAGIC, sizeof(MAGIC));
+        put(header, VERSION);
+        put(header, static_cast<uint32_t>(sizeof(Money::Rep)));
+        fwrite(header.data(), 1, header.size(), file);
+        syncFile(file);
+    }
+
+    stopping = false;
+    failing = false;
+    if (durability != Durability::EveryRecord) {
+        flusher = thread(&Journal::runFlusher, this);
+    }
+    return true;
+}
+
+// Stops the flusher, commits the remaining records and closes the file
+void Journal::close() {
+    if (file == nullptr) {
+        return;
+    }
+    {
+        lock_guard<mutex> lock(bufferMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (flusher.joinable()) {
+        flusher.join();
+    }
+    if (!flush()) {
+        cerr << "Error: " << buffer.size() << " bytes of journal records could not be written.\n";
+        buffer.clear();
+    }
+    fclose(file);
+    file = nullptr;
+}
+
+// Sets how often, and after how many buffered bytes, a group commit happens
+void Journal::setGroupCommit(chrono::milliseconds period, size_t bytes) {
+    lock_guard<mutex> lock(bufferMutex);
+    interval = period;
+    groupBytes = bytes;
+}
+
+// Frames one record and adds it to the buffer. The checksum covers the type
+// byte and the payload, so a half-written record never replays.
+void Journal::append(RecordType type, const char* payload, size_t length) {
+    char header[RECORD_HEADER_SIZE];
+    uint32_t size = static_cast<uint32_t>(length);
+    uint32_t crc = crc32(payload, length, crc32(&type, 1));
+    memcpy(header, &size, 4);
+    memcpy(header + 4, &crc, 4);
+    header[8] = static_cast<char>(type);
+
+    bool full;
+    {
+        lock_guard<mutex> lock(bufferMutex);
+        buffer.append(header, RECORD_HEADER_SIZE);
+        buffer.append(payload, length);
+        full = buffer.size() >= groupBytes;
+    }
+
+    if (durability == Durability::EveryRecord) {
+        flush();
+    } else if (full) {
+        wake.notify_one();
+    }
+}
+
+// Logs the creation of an account
+void Journal::logAccount(string_view number, string_view description) {
+    if (file == nullptr) {
+        return;
+    }
+    thread_local string payload;
+    payload.clear();
+    putNumber(payload, number);
+    put(payload, static_cast<uint32_t>(description.size()));
+    payload.append(description);
+    append(ACCOUNT, payload.data(), payload.size());
+}
+
+// Logs one posting
+void Journal::logPosting(string_view number, Money amount, char debitCredit, int64_t timestamp) {
+    if (file == nullptr) {
+        return;
+    }
+    thread_local string payload;
+    payload.clear();
+    putNumber(payload, number);
+    put(payload, amount.minorUnits());
+    payload.push_back(debitCredit);
+    put(payload, timestamp);
+    append(POSTING, payload.data(), payload.size());
+}
+
+// Logs a whole journal entry as one record, so it is replayed completely
+// or, if the record is torn, not at all
+void Journal::logEntry(span<const Posting> lines, int64_t timestamp) {
+    if (file == nullptr) {
+        return;
+    }
+    thread_local string payload;
+    payload.clear();
+    put(payload, timestamp);
+    put(payload, static_cast<uint16_t>(lines.size()));
+    for (const Posting& line : lines) {
+        putNumber(payload, line.accountNumber);
+        put(payload, line.amount.minorUnits());
+        payload.push_back(line.debitCredit);
+    }
+    append(ENTRY, payload.data(), payload.size());
+}
+
+// Logs the deletion of an account's transaction by sequence number
+void Journal::logDeletion(string_view number, uint32_t sequence) {
+    if (file == nullptr) {
+        return;
+    }
+    thread_local string payload;
+    payload.clear();
+    putNumber(payload, number);
+    put(payload, sequence);
+    append(DELETION, payload.data(), payload.size());
+}
+
+// Writes everything buffered so far and syncs it (unless durability is None).
+// Holding writeMutex across the swap and the write keeps records in order.
+// If the write or the sync fails, whatever part of the group reached the
+// file is cut off again and the group goes back in front of the records
+// logged since, so the next flush retries all of it. Returns false if the
+// records are still buffered.
+bool Journal::flush() {
+    if (file == nullptr) {
+        return true;
+    }
+    lock_guard<mutex> writeLock(writeMutex);
+    {
+        lock_guard<mutex> lock(bufferMutex);
+        if (buffer.empty()) {
+            return true;
+        }
+        spare.swap(buffer);  // buffer gets the old write buffer's capacity back
+    }
+
+    long start = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+    bool written = start >= 0 && fwrite(spare.data(), 1, spare.size(), file) == spare.size();
+    if (written) {
+        written = durability == Durability::None ? fflush(file) == 0 : syncFile(file);
+    }
+    if (written) {
+        if (failing.exchange(false)) {
+            cerr << "Journal writes have resumed.\n";
+        }
+        spare.clear();
+        return true;
+    }
+
+    clearerr(file);
+    if (start < 0 || !truncateFile(file, start)) {
+        cerr << "Error: Could not cut a failed write off the journal.\n";
+    }
+    if (!failing.exchange(true)) {
+        cerr << "Error: Could not write to the journal; its records are kept and retried.\n";
+    }
+    {
+        lock_guard<mutex> lock(bufferMutex);
+        spare.append(buffer);
+        buffer.swap(spare);
+    }
+    spare.clear();
+    return false;
+}
+
+// Commits everything logged so far and returns where the next record goes
+uint64_t Journal::position() {
+    if (file == nullptr) {
+        return 0;
+    }
+    flush();
+    lock_guard<mutex> writeLock(writeMutex);
+    return static_cast<uint64_t>(ftell(file));
+}
+
+// Group-commit loop: wakes every interval, or early when the buffer fills
+void Journal::runFlusher() {
+    unique_lock<mutex> lock(bufferMutex);
+    while (!stopping) {
+        // After a failure, retry once per interval rather than whenever the buffer is full
+        wake.wait_for(lock, interval, [&] { return stopping || (buffer.size() >= groupBytes && !failing); });
+        if (buffer.empty()) {
+            continue;
+        }
+        lock.unlock();
+        flush();
+        lock.lock();
+    }
+}
+
+// Applies every intact record of filename from offset from on to tree, in
+// order. A snapshot passes the offset it was taken at. Consecutive
+// postings are applied through postBatch and consecutive journal entries
+// through postEntries; any other record first applies what is pending
+// before it so sequence numbers line up.
+JournalReplayStats Journal::replay(const string& filename, ForestTree& tree, uint64_t from) {
+    JournalReplayStats stats;
+    auto start = chrono::steady_clock::now();
+
+    error_code error;
+    if (!filesystem::exists(filename, error) || filesystem::file_size(filename, error) == 0) {
+        return stats;  // Nothing journaled yet
+    }
+
+    MappedFile mapped;
+    if (!mapped.open(filename)) {
+        cout << "Error: Could not open journal \"" << filename << "\".\n";
+        return stats;
+    }
+    string_view contents = mapped.contents();
+    stats.validBytes = validLength(contents, stats.tornTail);
+    if (stats.validBytes == 0) {
+        cout << "Error: \"" << filename << "\" is not a journal of this version.\n";
+        return stats;
+    }
+
+    if (from < HEADER_SIZE || from > stats.validBytes) {
+        cout << "Error: The snapshot is newer than journal \"" << filename << "\"; its tail was not replayed.\n";
+        return stats;
+    }
+
+    // Nothing replayed may be journaled a second time
+    Journal* attached = tree.journal;
+    tree.journal = nullptr;
+
+    vector<Posting> pending;
+    pending.reserve(REPLAY_BATCH);
+    auto applyPending = [&]() {
+        if (pending.empty()) {
+            return;
+        }
+        PostingBatchResult result = tree.postBatch(pending);
+        stats.postings += result.posted;
+        stats.skipped += result.rejected.size();
+        pending.clear();
+    };
+
+    // Journal entries wait in their own list; their lines are pointed at
+    // once entryLines stops growing
+    vector<Posting> entryLines;
+    vector<JournalEntry> entries;
+    vector<uint16_t> entrySizes;
+    auto applyEntries = [&]() {
+        if (entries.empty()) {
+            return;
+        }
+        size_t first = 0;
+        for (size_t k = 0; k < entries.size(); ++k) {
+            entries[k].lines = span<const Posting>(entryLines).subspan(first, entrySizes[k]);
+            first += entrySizes[k];
+        }
+        PostingBatchResult result = tree.postEntries(entries);
+        stats.entries += result.posted;
+        stats.postings += entryLines.size();
+        for (size_t index : result.rejected) {
+            stats.postings -= entries[index].lines.size();
+        }
+        stats.skipped += result.rejected.size();
+        entryLines.clear();
+        entries.clear();
+        entrySizes.clear();
+    };
+
+    size_t offset = from;
+    while (offset < stats.validBytes) {
+        uint32_t length;
+        memcpy(&length, contents.data() + offset, 4);
+        RecordType type = static_cast<RecordType>(contents[offset + 8]);
+        string_view payload = contents.substr(offset + RECORD_HEADER_SIZE, length);
+        offset += RECORD_HEADER_SIZE + length;
+
+        size_t cursor = 0;
+        if (type == ENTRY) {
+            applyPending();
+            if (!readEntry(payload, entryLines, entries, entrySizes)) {
+                ++stats.skipped;
+            } else if (entryLines.size() >= REPLAY_BATCH) {
+                applyEntries();
+            }
+            continue;
+        }
+        applyEntries();
+
+        string_view number;
+        if (!getText<uint16_t>(payload, cursor, number)) {
+            ++stats.skipped;
+            continue;
+        }
+
+        if (type == POSTING) {
+            Money::Rep minor;
+            char debitCredit;
+            int64_t timestamp;
+            if (get(payload, cursor, minor) && get(payload, cursor, debitCredit) && get(payload, cursor, timestamp)) {
+                pending.push_back(Posting{number, Money::fromMinor(minor), debitCredit, timestamp});
+                if (pending.size() == REPLAY_BATCH) {
+                    applyPending();
+                }
+            } else {
+                ++stats.skipped;
+            }
+            continue;
+        }
+
+        applyPending();
+        if (type == ACCOUNT) {
+            string_view description;
+            Account* account = nullptr;
+            if (getText<uint32_t>(payload, cursor, description) && tree.isValidAccountNumber(number) &&
+                (tree.hierarchyDirty || tree.adoptionFits(number))) {
+                bool linked = !tree.hierarchyDirty;
+                account = tree.insertAccount(number, description);
+                if (account && linked) {
+                    tree.linkAccount(account);  // Incremental, as addAccount does
+                    tree.hierarchyDirty = false;
+                }
+            }
+            account ? ++stats.accounts : ++stats.skipped;
+        } else if (type == DELETION) {
+            uint32_t sequence;
+            Account* account = tree.accounts.find(number);
+            if (get(payload, cursor, sequence) && account && account->findTransaction(sequence) &&
+                account->deleteTransaction(sequence)) {
+                ++stats.deletions;
+            } else {
+                ++stats.skipped;
+            }
+        } else {
+            ++stats.skipped;  // Written by a newer version
+        }
+    }
+    applyPending();
+    applyEntries();
+
+    tree.journal = attached;
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return stats;
+}
@@ -0,0 +1,151 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: Journal.h
+ * Purpose: Defines the Journal class, an append-only binary log of account
+ *          creations, postings and deletions that makes a ForestTree durable.
+ *
+ * File format (native byte order):
+ *  - Header: "COAJRNL" + '\0', uint32 version, uint32 sizeof(Money::Rep).
+ *  - Records: uint32 payload length, uint32 CRC-32 of type and payload,
+ *    uint8 type, payload. Account numbers are stored as uint16 length + bytes.
+ *      ACCOUNT:  number, uint32 description length + bytes
+ *      POSTING:  number, Money::Rep amount, uint8 'D' or 'C', int64 timestamp
+ *      DELETION: number, uint32 transaction sequence number
+ *      ENTRY:    int64 timestamp, uint16 line count, then per line: number,
+ *                Money::Rep amount, uint8 'D' or 'C'
+ *
+ * Durability:
+ *  - Durability::None: records are written by a background thread, never
+ *    fsync'd. Survives a process crash, not a power loss.
+ *  - Durability::AsyncGroupCommit: the background thread writes and fsyncs
+ *    every interval (or as soon as a buffer fills), so many records share
+ *    one sync. The logging call does not wait for it: a power loss can lose
+ *    the records of the last interval, never part of a record.
+ *  - Durability::EveryRecord: every record is written and fsync'd before the
+ *    logging call returns.
+ *
+ * A crash can leave a torn record at the end of the file. replay() stops at
+ * the first record whose length or checksum is wrong, and open() truncates
+ * the file there before appending. A write or sync that fails is cut back
+ * off the file the same way, and its records stay buffered and are written
+ * again by the next flush, so nothing logged is dropped while the process
+ * runs and no torn record is left before later ones.
+ *
+ * Functions:
+ *  - bool open(const string& filename, Durability durability):
+ *      Opens or creates the journal for appending.
+ *  - void logAccount / logPosting / logEntry / logDeletion:
+ *      Append one record. Safe to call from several threads. A journal
+ *      entry is one record, so a crash never leaves it half-logged.
+ *  - bool flush():
+ *      Writes and fsyncs everything logged so far; false if that failed and
+ *      the records are still buffered.
+ *  - uint64_t position():
+ *      Flushes and returns the end of the journal, e.g. to record in a snapshot.
+ *  - static JournalReplayStats replay(const string& filename, ForestTree& tree,
+ *                                     uint64_t from):
+ *      Applies every intact record at or after offset from to tree, e.g. at
+ *      startup. The default starts with the first record. A record the tree
+ *      refuses, such as a posting that would overflow a balance (which only
+ *      older versions journaled), is counted as skipped instead.
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <span>
+#include "Money.h"
+#include "Transaction.h"
+
+using namespace std;
+
+class ForestTree;
+
+enum class Durability { None, AsyncGroupCommit, EveryRecord };
+
+/**
+ * Struct: JournalReplayStats
+ * Purpose: What replay() found and applied.
+ */
+struct JournalReplayStats {
+    size_t accounts = 0;    // Account records applied
+    size_t postings = 0;    // Postings applied, including journal entry lines
+    size_t entries = 0;     // Journal entry records applied
+    size_t deletions = 0;   // Deletion records applied
+    size_t skipped = 0;     // Records that no longer applied (e.g. unknown account, amount out of range)
+    size_t validBytes = 0;  // Length of the intact prefix of the file
+    bool tornTail = false;  // True if a damaged record ended the scan early
+    double seconds = 0;     // Wall-clock replay time
+};
+
+/**
+ * Class: Journal
+ * Purpose: Buffers records in memory and commits them to disk in groups.
+ */
+class Journal {
+public:
+    enum RecordType : uint8_t { ACCOUNT = 1, POSTING = 2, DELETION = 3, ENTRY = 4 };
+
+    static constexpr uint32_t VERSION = 3;  // 2: postings carry a timestamp; 3: entry records
+    static constexpr size_t HEADER_SIZE = 16;
+    static constexpr size_t RECORD_HEADER_SIZE = 9;
+
+private:
+    FILE* file;                      // Journal file, opened for appending
+    Durability durability;           // How hard each commit tries
+    chrono::milliseconds interval;   // Group-commit period
+    size_t groupBytes;               // Buffer size that triggers an early commit
+
+    mutex bufferMutex;               // Guards buffer and stopping
+    condition_variable wake;         // Wakes the flusher early
+    string buffer;                   // Records not yet written
+    bool stopping;                   // Tells the flusher to exit
+
+    mutex writeMutex;                // Keeps writes to the file in order
+    string spare;                    // Reused write buffer
+    atomic<bool> failing;            // The last write failed; its records wait in buffer
+    thread flusher;                  // Background group-commit thread
+
+    void append(RecordType type, const char* payload, size_t length);  // Frames a record
+    void runFlusher();                                                  // Flusher loop
+
+    // Length of the intact prefix of a journal image (0 if the header is bad)
+    static size_t validLength(string_view contents, bool& tornTail);
+
+public:
+    Journal();
+    ~Journal();
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    bool open(const string& filename, Durability durability = Durability::AsyncGroupCommit);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    // Group-commit tuning: commit at least this often, or when this many bytes wait
+    void setGroupCommit(chrono::milliseconds interval, size_t bytes);
+
+    void logAccount(string_view number, string_view description);
+    void logPosting(string_view number, Money amount, char debitCredit, int64_t timestamp);
+    void logEntry(span<const Posting> lines, int64_t timestamp);
+    void logDeletion(string_view number, uint32_t sequence);
+
+    bool flush();          // Writes and syncs everything logged so far
+    uint64_t position();   // Flushes and returns the file length
+
+    static JournalReplayStats replay(const string& filename, ForestTree& tree, uint64_t from = HEADER_SIZE);
+};
+
+#endif
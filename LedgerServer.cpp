@@ -0,0 +1,663 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: LedgerServer.cpp
+ * Purpose: Implements the LedgerServer class: a single-threaded epoll loop
+ *          that accepts clients on a Unix socket, decodes pipelined binary
+ *          requests in place and batches runs of postings into postBatch.
+ */
+
+#include "LedgerServer.h"
+#include <chrono>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <csignal>
+#include <cerrno>
+#include <atomic>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+// Appends the raw bytes of a trivially copyable value
+template <typename T>
+void put(string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+// Appends a uint16 length followed by the text, cut to fit
+void putText(string& out, string_view text) {
+    text = text.substr(0, UINT16_MAX);
+    put(out, static_cast<uint16_t>(text.size()));
+    out.append(text);
+}
+
+// Reads a value at offset, advancing it; false if the payload is too short
+template <typename T>
+bool get(string_view payload, size_t& offset, T& value) {
+    if (payload.size() - offset < sizeof(T)) {
+        return false;
+    }
+    memcpy(&value, payload.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+// Reads a uint16 length-prefixed string
+bool getText(string_view payload, size_t& offset, string_view& text) {
+    uint16_t length;
+    if (!get(payload, offset, length) || payload.size() - offset < length) {
+        return false;
+    }
+    text = payload.substr(offset, length);
+    offset += length;
+    return true;
+}
+
+// Removes the trailing newlines of a captured message
+string_view trimMessage(string_view text) {
+    while (!text.empty() && (text.back() == '\n' || text.back() == ' ')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+// Drops the "Error: " that the tree and Money put in front of a message
+string_view withoutErrorPrefix(string_view text) {
+    return text.substr(0, 7) == "Error: " ? text.substr(7) : text;
+}
+
+// Points cout and cerr at a capture buffer for as long as it lives, so the
+// console streams come back even when a request throws
+class CaptureStreams {
+private:
+    streambuf* console;
+    streambuf* errors;
+
+public:
+    explicit CaptureStreams(ostream& capture)
+        : console(cout.rdbuf(capture.rdbuf())), errors(cerr.rdbuf(capture.rdbuf())) {}
+    ~CaptureStreams() {
+        cerr.rdbuf(errors);
+        cout.rdbuf(console);
+    }
+
+    CaptureStreams(const CaptureStreams&) = delete;
+    CaptureStreams& operator=(const CaptureStreams&) = delete;
+};
+
+// Frame header: uint32 length, uint32 tag, uint8 op or status
+const size_t LENGTH_BYTES = sizeof(uint32_t);
+const size_t HEADER_BYTES = sizeof(uint32_t) + sizeof(uint8_t);
+
+// The one POST problem answered with BAD_REQUEST rather than FAILED
+const char* const MALFORMED_POST = "Malformed POST request.";
+
+} // namespace
+
+// Sends a reply frame's header and payload to the connection's output
+void LedgerServer::reply(Connection& connection, uint32_t tag, uint8_t status, string_view payload) {
+    put(connection.output, static_cast<uint32_t>(HEADER_BYTES + payload.size()));
+    put(connection.output, tag);
+    put(connection.output, status);
+    connection.output.append(payload);
+    ++last.requests;
+    if (status != OK) {
+        ++last.failures;
+    }
+}
+
+// Replies with a status and a message
+void LedgerServer::replyError(Connection& connection, uint32_t tag, uint8_t status, string_view message) {
+    string payload;
+    putText(payload, message);
+    reply(connection, tag, status, payload);
+}
+
+// Writes a one-line summary of the last run
+void LedgerServer::printStats(ostream& os) const {
+    os << "Served " << last.requests << " requests";
+    if (last.failures > 0) {
+        os << " (" << last.failures << " failed)";
+    }
+    os << " to " << last.connections << " clients in " << last.seconds << " s: "
+       << static_cast<size_t>(last.requestsPerSecond()) << " requests/s, "
+       << last.postBatches << " posting batches, " << last.bytesIn << " bytes in, "
+       << last.bytesOut << " bytes out\n";
+}
+
+// Handles frames in order while the client's unsent replies fit under
+// MAX_PENDING_OUTPUT. Consecutive POSTs go to handlePostRun together.
+void LedgerServer::handleRequests(Connection& connection) {
+    while (!connection.broken && connection.output.size() - connection.sent < MAX_PENDING_OUTPUT) {
+        string_view pending = string_view(connection.input).substr(connection.consumed);
+        uint32_t length;
+        if (pending.size() < LENGTH_BYTES) {
+            break;
+        }
+        memcpy(&length, pending.data(), sizeof(length));
+        if (length < HEADER_BYTES || length > MAX_REQUEST_BYTES) {
+            connection.broken = true;  // Not a frame: the stream cannot be resynchronised
+            break;
+        }
+        if (pending.size() < LENGTH_BYTES + length) {
+            break;
+        }
+
+        string_view frame = pending.substr(LENGTH_BYTES, length);
+        uint32_t tag;
+        memcpy(&tag, frame.data(), sizeof(tag));
+        uint8_t op = static_cast<uint8_t>(frame[sizeof(tag)]);
+        if (op == POST) {
+            connection.consumed += handlePostRun(connection, connection.consumed);
+        } else {
+            handleRequest(connection, tag, op, frame.substr(HEADER_BYTES));
+            connection.consumed += LENGTH_BYTES + length;
+        }
+    }
+
+    // Drop handled bytes once they are most of the buffer
+    if (connection.consumed == connection.input.size()) {
+        connection.input.clear();
+        connection.consumed = 0;
+    } else if (connection.consumed > connection.input.size() / 2) {
+        connection.input.erase(0, connection.consumed);
+        connection.consumed = 0;
+    }
+}
+
+// Checks whether the unhandled input holds a whole frame, or at least its
+// length word if that length is one handleRequests will refuse
+bool LedgerServer::hasCompleteFrame(const Connection& connection) {
+    string_view pending = string_view(connection.input).substr(connection.consumed);
+    uint32_t length;
+    if (pending.size() < LENGTH_BYTES) {
+        return false;
+    }
+    memcpy(&length, pending.data(), sizeof(length));
+    return length < HEADER_BYTES || length > MAX_REQUEST_BYTES || pending.size() >= LENGTH_BYTES + length;
+}
+
+// Decodes consecutive complete POST frames from offset, posts the valid
+// ones with one postBatch call and answers every frame in order
+size_t LedgerServer::handlePostRun(Connection& connection, size_t offset) {
+    posts.clear();
+    postTags.clear();
+    postErrors.clear();
+    postRequests.clear();
+
+    size_t begin = offset;
+    while (postTags.size() < MAX_POST_RUN && connection.input.size() - offset >= LENGTH_BYTES + HEADER_BYTES) {
+        const char* frame = connection.input.data() + offset;
+        uint32_t length;
+        memcpy(&length, frame, sizeof(length));
+        if (length < HEADER_BYTES || length > MAX_REQUEST_BYTES ||
+            connection.input.size() - offset < LENGTH_BYTES + length ||
+            static_cast<uint8_t>(frame[LENGTH_BYTES + sizeof(uint32_t)]) != POST) {
+            break;  // Incomplete, malformed or another op: handleRequests takes over
+        }
+
+        uint32_t tag;
+        memcpy(&tag, frame + LENGTH_BYTES, sizeof(tag));
+        string_view payload(frame + LENGTH_BYTES + HEADER_BYTES, length - HEADER_BYTES);
+        offset += LENGTH_BYTES + length;
+
+        Posting posting;
+        Money::Rep amount = 0;
+        uint8_t debitCredit = 0;
+        size_t cursor = 0;
+        const char* problem = nullptr;
+        if (!getText(payload, cursor, posting.accountNumber) || !get(payload, cursor, amount) ||
+            !get(payload, cursor, debitCredit) || !get(payload, cursor, posting.timestamp)) {
+            problem = MALFORMED_POST;
+        } else if (!tree.isValidAccountNumber(posting.accountNumber)) {
+            problem = "Invalid account number. Must be numeric.";
+        } else if (amount < 0) {
+            problem = "Transaction amount must be non-negative.";
+        } else if (debitCredit != 'D' && debitCredit != 'C') {
+            problem = "Invalid transaction type. Use 'D' for Debit or 'C' for Credit.";
+        }
+
+        postTags.push_back(tag);
+        postErrors.push_back(problem);
+        if (!problem) {
+            posting.amount = Money::fromMinor(amount);
+            posting.debitCredit = static_cast<char>(debitCredit);
+            postRequests.push_back(static_cast<uint32_t>(postTags.size() - 1));
+            posts.push_back(posting);
+        }
+    }
+
+    // Numbers were checked above, so postBatch only refuses unknown accounts
+    // and amounts that would overflow a balance
+    if (!posts.empty()) {
+        PostingBatchResult result = tree.postBatch(posts);
+        ++last.postBatches;
+        size_t nextOutOfRange = 0;  // Both lists are in index order
+        for (size_t index : result.rejected) {
+            bool outOfRange = nextOutOfRange < result.outOfRange.size() && result.outOfRange[nextOutOfRange] == index;
+            nextOutOfRange += outOfRange;
+            postErrors[postRequests[index]] = outOfRange ? "Amount is out of range." : "Account not found.";
+        }
+    }
+
+    for (size_t i = 0; i < postTags.size(); ++i) {
+        if (postErrors[i] == nullptr) {
+            reply(connection, postTags[i], OK);
+        } else {
+            replyError(connection, postTags[i], postErrors[i] == MALFORMED_POST ? BAD_REQUEST : FAILED,
+                       postErrors[i]);
+        }
+    }
+    return offset - begin;
+}
+
+// Decodes and runs one request. The tree reports failures by printing
+// "Error: ..." (accounts on cerr), so both streams are captured while it
+// runs and the text becomes the FAILED message. An exception the request
+// throws is answered with FAILED in the same way.
+void LedgerServer::handleRequest(Connection& connection, uint32_t tag, uint8_t op, string_view payload) {
+    size_t cursor = 0;
+    string_view number, text;
+    string result;
+    string failure;  // What the request threw, if anything
+    bool wellFormed = true;
+
+    captured.str("");
+    try {
+        CaptureStreams capture(captured);
+        switch (op) {
+        case PING:
+            break;
+        case ADD_ACCOUNT:
+            if ((wellFormed = getText(payload, cursor, number) && getText(payload, cursor, text))) {
+                tree.addAccount(string(number), string(text));
+            }
+            break;
+        case DELETE_TRANSACTION: {
+            uint32_t id;
+            if ((wellFormed = getText(payload, cursor, number) && get(payload, cursor, id))) {
+                if (id > static_cast<uint32_t>(INT32_MAX)) {
+                    cout << "Error: Invalid transaction ID.\n";
+                } else {
+                    tree.deleteTransaction(string(number), static_cast<int>(id));
+                }
+            }
+            break;
+        }
+        case SEARCH:
+            if ((wellFormed = getText(payload, cursor, number))) {
+                if (Account* account = tree.searchAccount(string(number))) {
+                    putText(result, account->description());
+                    put(result, account->balance().minorUnits());
+                    put(result, account->rollupBalance().minorUnits());
+                } else if (captured.view().empty()) {
+                    cout << "Error: Account not found.\n";
+                }
+            }
+            break;
+        case BALANCE: {
+            int64_t time;
+            if ((wellFormed = getText(payload, cursor, number) && get(payload, cursor, time))) {
+                Money balance;
+                if (time != Transaction::NO_TIME) {
+                    if (tree.balanceAsOf(string(number), time, balance)) {
+                        put(result, balance.minorUnits());
+                    }
+                } else if (Account* account = tree.searchAccount(string(number))) {
+                    put(result, account->rollupBalance().minorUnits());
+                } else if (captured.view().empty()) {
+                    cout << "Error: Account not found.\n";
+                }
+            }
+            break;
+        }
+        case REPORT: {
+            uint8_t kind, format;
+            if ((wellFormed = get(payload, cursor, kind) && get(payload, cursor, format) &&
+                              getText(payload, cursor, text) && kind <= INCOME_STATEMENT)) {
+                string filename(text);
+                FinancialReportOptions options;
+                options.format = format == 1 ? ReportFormat::Csv : ReportFormat::Text;
+                if (kind == FOREST_TREE) {
+                    tree.printForestTree(filename);
+                } else if (kind == TRIAL_BALANCE) {
+                    tree.printTrialBalance(filename, options);
+                } else if (kind == BALANCE_SHEET) {
+                    tree.printBalanceSheet(filename, options);
+                } else {
+                    tree.printIncomeStatement(filename, options);
+                }
+            }
+            break;
+        }
+        default:
+            wellFormed = false;
+        }
+    } catch (const exception& error) {
+        failure = *error.what() ? error.what() : "The request failed.";
+    }
+
+    string_view printed = trimMessage(captured.view());
+    if (!wellFormed) {
+        replyError(connection, tag, BAD_REQUEST, op <= REPORT ? "Malformed request." : "Unknown request type.");
+    } else if (!failure.empty()) {
+        replyError(connection, tag, FAILED, withoutErrorPrefix(failure));
+    } else if (printed.substr(0, 7) == "Error: ") {
+        replyError(connection, tag, FAILED, printed.substr(7));
+    } else {
+        reply(connection, tag, OK, result);
+    }
+}
+
+#ifdef __linux__
+
+namespace {
+
+// Server that SIGINT and SIGTERM stop while it runs
+atomic<LedgerServer*> signalTarget{nullptr};
+
+// Signal handler: may run on any thread (the journal has its own)
+void stopOnSignal(int) {
+    if (LedgerServer* server = signalTarget.load()) {
+        server->stop();
+    }
+}
+
+} // namespace
+
+// Constructor: Creates the eventfd first, so stop() works before run()
+LedgerServer::LedgerServer(ForestTree& tree, ostream& log)
+    : tree(tree), log(log), listenFd(-1), epollFd(-1), stopFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {}
+
+LedgerServer::~LedgerServer() {
+    if (stopFd >= 0) {
+        close(stopFd);
+    }
+}
+
+// Wakes the event loop; write() on an eventfd is async-signal-safe
+void LedgerServer::stop() {
+    uint64_t one = 1;
+    if (write(stopFd, &one, sizeof(one)) < 0) {
+        // The counter is already non-zero: a stop is pending
+    }
+}
+
+// Sets up the socket, epoll and the signal handlers, then dispatches
+// events until a signal or stop() arrives
+bool LedgerServer::run(const string& socketPath) {
+    last = ServerStats();
+    auto start = chrono::steady_clock::now();
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        log << "Error: Invalid socket path \"" << socketPath << "\".\n";
+        return false;
+    }
+    memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    // Replace a socket left by a server that did not shut down, but never
+    // a live server's socket or another kind of file
+    struct stat existing;
+    if (lstat(socketPath.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            log << "Error: \"" << socketPath << "\" exists and is not a socket.\n";
+            return false;
+        }
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool live = probe >= 0 && connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        if (probe >= 0) {
+            close(probe);
+        }
+        if (live) {
+            log << "Error: Another server is listening on \"" << socketPath << "\".\n";
+            return false;
+        }
+        unlink(socketPath.c_str());
+    }
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        listen(listenFd, SOMAXCONN) < 0) {
+        log << "Error: Could not listen on \"" << socketPath << "\": " << strerror(errno) << "\n";
+        shutdown(socketPath);
+        return false;
+    }
+
+    // SIGINT and SIGTERM call stop(), whichever thread they land on; SIGPIPE
+    // is avoided with MSG_NOSIGNAL
+    struct sigaction action{}, previousInt, previousTerm;
+    action.sa_handler = stopOnSignal;
+    sigemptyset(&action.sa_mask);
+    signalTarget.store(this);
+    sigaction(SIGINT, &action, &previousInt);
+    sigaction(SIGTERM, &action, &previousTerm);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    for (int fd : {listenFd, stopFd}) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+    log << "Serving the ledger on \"" << socketPath << "\"." << endl;
+
+    epoll_event events[64];
+    bool running = true;
+    while (running) {
+        int ready = epoll_wait(epollFd, events, 64, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            log << "Error: epoll_wait failed: " << strerror(errno) << "\n";
+            break;
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptClients();
+                continue;
+            }
+            if (fd == stopFd) {
+                running = false;
+                continue;
+            }
+
+            auto found = connections.find(fd);
+            if (found == connections.end()) {
+                continue;  // Closed earlier in this round
+            }
+            Connection& connection = found->second;
+            if (events[i].events & EPOLLIN) {
+                readInput(connection);
+            } else if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                connection.peerClosed = true;
+            }
+
+            // Handle, write, and handle again if writing made room. A throw
+            // that handleRequest did not answer (e.g. out of memory in a
+            // POST run) may leave the run half-applied, so the client's
+            // replies can no longer be trusted: drop it and keep serving.
+            try {
+                size_t handled;
+                do {
+                    handled = last.requests;
+                    handleRequests(connection);
+                    flushOutput(connection);
+                } while (last.requests != handled && !connection.broken &&
+                         connection.sent == connection.output.size() &&
+                         connection.input.size() > connection.consumed);
+            } catch (const exception& error) {
+                log << "Error: Dropped a client whose request failed: " << withoutErrorPrefix(error.what()) << "\n";
+                connection.broken = true;
+            }
+            updateEvents(connection);
+        }
+    }
+
+    shutdown(socketPath);
+    sigaction(SIGINT, &previousInt, nullptr);
+    sigaction(SIGTERM, &previousTerm, nullptr);
+    signalTarget.store(nullptr);
+    last.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+// Accepts until the backlog is empty
+void LedgerServer::acceptClients() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                log << "Error: accept failed: " << strerror(errno) << "\n";
+            }
+            return;
+        }
+        Connection& connection = connections[fd];
+        connection.fd = fd;
+        connection.events = EPOLLIN;
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event);
+        ++last.connections;
+    }
+}
+
+// Reads up to READ_BYTES at a time until the socket is drained or the
+// unhandled input holds a full request and a full read more
+void LedgerServer::readInput(Connection& connection) {
+    while (connection.input.size() - connection.consumed < MAX_REQUEST_BYTES + READ_BYTES) {
+        size_t used = connection.input.size();
+        connection.input.resize(used + READ_BYTES);
+        ssize_t got = recv(connection.fd, connection.input.data() + used, READ_BYTES, 0);
+        connection.input.resize(used + max<ssize_t>(got, 0));
+        if (got > 0) {
+            last.bytesIn += got;
+            if (static_cast<size_t>(got) < READ_BYTES) {
+                return;  // Drained for now
+            }
+        } else if (got == 0) {
+            connection.peerClosed = true;
+            return;
+        } else {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                connection.broken = true;
+            }
+            return;
+        }
+    }
+}
+
+// Writes pending replies until the socket would block
+void LedgerServer::flushOutput(Connection& connection) {
+    while (connection.sent < connection.output.size() && !connection.broken) {
+        ssize_t wrote = send(connection.fd, connection.output.data() + connection.sent,
+                             connection.output.size() - connection.sent, MSG_NOSIGNAL);
+        if (wrote > 0) {
+            connection.sent += wrote;
+            last.bytesOut += wrote;
+        } else if (wrote < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else if (wrote < 0 && errno == EINTR) {
+            continue;
+        } else {
+            connection.broken = true;
+        }
+    }
+    if (connection.sent == connection.output.size()) {
+        connection.output.clear();
+        connection.sent = 0;
+    }
+}
+
+// Waits for input while the client may send and its replies fit, and for
+// writability while replies are pending. A client that has closed and has
+// nothing left to receive is closed; a partial frame it left behind can
+// never be completed, so it is dropped with the connection.
+void LedgerServer::updateEvents(Connection& connection) {
+    bool pendingOutput = connection.sent < connection.output.size();
+    if (connection.broken || (connection.peerClosed && !pendingOutput && !hasCompleteFrame(connection))) {
+        closeConnection(connection.fd);
+        return;
+    }
+
+    uint32_t wanted = 0;
+    if (!connection.peerClosed && connection.output.size() - connection.sent < MAX_PENDING_OUTPUT) {
+        wanted |= EPOLLIN;
+    }
+    if (pendingOutput) {
+        wanted |= EPOLLOUT;
+    }
+    if (wanted != connection.events) {
+        epoll_event event{};
+        event.events = wanted;
+        event.data.fd = connection.fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.events = wanted;
+    }
+}
+
+void LedgerServer::closeConnection(int fd) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    connections.erase(fd);
+}
+
+// Closes the clients, the listener and the loop's descriptors, and removes
+// the socket file
+void LedgerServer::shutdown(const string& socketPath) {
+    for (auto& [fd, connection] : connections) {
+        close(fd);
+    }
+    connections.clear();
+    for (int* fd : {&listenFd, &epollFd}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+    unlink(socketPath.c_str());
+
+    // Consume the stop request, if any, so the next run() serves again
+    uint64_t stops;
+    if (read(stopFd, &stops, sizeof(stops)) < 0) {
+        // Nothing was pending
+    }
+}
+
+#else
+
+LedgerServer::LedgerServer(ForestTree& tree, ostream& log)
+    : tree(tree), log(log), listenFd(-1), epollFd(-1), stopFd(-1) {}
+
+LedgerServer::~LedgerServer() {}
+
+void LedgerServer::stop() {}
+
+// The event loop is built on epoll and eventfd
+bool LedgerServer::run(const string& socketPath) {
+    log << "Error: The ledger server needs Linux (epoll).\n";
+    return false;
+}
+
+void LedgerServer::acceptClients() {}
+void LedgerServer::readInput(Connection&) {}
+void LedgerServer::flushOutput(Connection&) {}
+void LedgerServer::updateEvents(Connection&) {}
+void LedgerServer::closeConnection(int) {}
+void LedgerServer::shutdown(const string&) {}
+
+#endif
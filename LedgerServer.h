@@ -0,0 +1,186 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: LedgerServer.h
+ * Purpose: Defines the LedgerServer class, a long-running daemon that keeps
+ *          a ForestTree resident and answers requests from local clients
+ *          over a Unix domain socket (Linux only: it uses epoll).
+ *
+ * Protocol (native byte order, like the journal):
+ *  - Request:  uint32 length, uint32 tag, uint8 op, payload. length counts
+ *    everything after itself and is at most MAX_REQUEST_BYTES.
+ *  - Response: uint32 length, uint32 tag, uint8 status, payload. The tag is
+ *    copied from the request. Status OK carries the op's result; FAILED and
+ *    BAD_REQUEST carry a uint16 length + message.
+ *  - Strings are uint16 length + bytes. Amounts are Money::Rep minor units
+ *    (8 bytes, 16 with COA_MONEY_128); times are int64 seconds since the
+ *    epoch, with Transaction::NO_TIME meaning "now".
+ *      PING:               -                                   -> -
+ *      ADD_ACCOUNT:        number, description                 -> -
+ *      POST:               number, amount, uint8 'D'/'C', time -> -
+ *      DELETE_TRANSACTION: number, uint32 transaction ID       -> -
+ *      SEARCH:             number          -> description, balance, roll-up
+ *      BALANCE:            number, time    -> roll-up balance at time
+ *      REPORT:             uint8 ReportKind, uint8 0 text / 1 CSV, filename
+ *                          -> - (the server writes the file)
+ *
+ * Pipelining:
+ *  - A client may send any number of requests without waiting. Each
+ *    connection's requests run in order and are answered in order. A run
+ *    of consecutive POST requests already in the buffer is applied with
+ *    one ForestTree::postBatch call, so roll-ups are propagated once for
+ *    the run.
+ *  - Replies are written from a per-connection buffer. While more than
+ *    MAX_PENDING_OUTPUT bytes are unsent the server stops reading from that
+ *    client, so a client that never reads cannot grow the server's memory.
+ *  - A malformed frame (bad length) closes the connection; an unknown op
+ *    or a short payload is answered with BAD_REQUEST.
+ *
+ * Event loop:
+ *  - One thread, level-triggered epoll over the listening socket, every
+ *    client and an eventfd written by stop(). SIGINT and SIGTERM call
+ *    stop() while run() is serving.
+ *    Every request touches the tree from that thread only, so the tree
+ *    needs no locking. Messages the tree prints while handling a request
+ *    are captured and returned as the FAILED message, as is the message of
+ *    an exception a request throws; a throw in the middle of a POST run
+ *    closes that client instead, since some of its postings may be applied.
+ *    Postings that would overflow a balance are answered with FAILED.
+ *
+ * Functions:
+ *  - bool run(const string& socketPath):
+ *      Listens on socketPath (replacing a stale socket there) and serves
+ *      clients until SIGINT, SIGTERM or stop(). Returns false if the socket
+ *      cannot be set up, or on systems without epoll.
+ *  - void stop():
+ *      Asks run() to return; safe from any thread or a signal handler.
+ *  - const ServerStats& stats() const / void printStats(ostream& os) const:
+ *      Counters and timing for the last run.
+ */
+
+#ifndef LEDGER_SERVER_H
+#define LEDGER_SERVER_H
+
+#include <string>
+#include <string_view>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include "ForestTree.h"
+
+using namespace std;
+
+/**
+ * Struct: ServerStats
+ * Purpose: Counters and timing gathered while serving clients.
+ */
+struct ServerStats {
+    size_t connections = 0;  // Clients accepted
+    size_t requests = 0;     // Requests answered
+    size_t failures = 0;     // Requests answered with FAILED or BAD_REQUEST
+    size_t postBatches = 0;  // postBatch calls made for runs of POST requests
+    size_t bytesIn = 0;      // Bytes read from clients
+    size_t bytesOut = 0;     // Bytes written to clients
+    double seconds = 0;      // Wall-clock time the server ran
+
+    double requestsPerSecond() const { return seconds > 0 ? requests / seconds : 0; }
+};
+
+/**
+ * Class: LedgerServer
+ * Purpose: epoll-driven Unix socket server over one resident ForestTree.
+ */
+class LedgerServer {
+public:
+    // Request types
+    enum Op : uint8_t { PING = 0, ADD_ACCOUNT = 1, POST = 2, DELETE_TRANSACTION = 3, SEARCH = 4, BALANCE = 5, REPORT = 6 };
+
+    // Response status
+    enum Status : uint8_t { OK = 0, FAILED = 1, BAD_REQUEST = 2 };
+
+    // Reports a REPORT request can write
+    enum ReportKind : uint8_t { FOREST_TREE = 0, TRIAL_BALANCE = 1, BALANCE_SHEET = 2, INCOME_STATEMENT = 3 };
+
+    static constexpr size_t MAX_REQUEST_BYTES = 64 << 10;    // Largest frame accepted
+    static constexpr size_t MAX_PENDING_OUTPUT = 1 << 20;    // Unsent bytes before reading pauses
+    static constexpr size_t READ_BYTES = 64 << 10;           // Bytes read per call
+    static constexpr size_t MAX_POST_RUN = 4096;             // POST requests per postBatch
+
+private:
+    // One client and its buffers
+    struct Connection {
+        int fd = -1;
+        string input;            // Bytes read but not yet handled, from consumed on
+        size_t consumed = 0;
+        string output;           // Replies not yet written, from sent on
+        size_t sent = 0;
+        uint32_t events = 0;     // epoll events currently registered
+        bool peerClosed = false; // The client will send nothing more
+        bool broken = false;     // Close without flushing (bad frame or write error)
+    };
+
+    ForestTree& tree;                           // Tree the requests act on
+    ostream& log;                               // Destination for server messages
+    int listenFd;                               // Listening socket
+    int epollFd;                                // epoll instance
+    int stopFd;                                 // eventfd written by stop()
+    unordered_map<int, Connection> connections; // Clients by descriptor
+    ostringstream captured;                     // What the tree printed during a request
+    vector<Posting> posts;                      // Postings of the current POST run
+    vector<uint32_t> postTags;                  // Tag of every request in the run
+    vector<const char*> postErrors;             // Why a request was not queued, or nullptr
+    vector<uint32_t> postRequests;              // Request in the run of every queued posting
+    ServerStats last;                           // Statistics for the last run
+
+    // Accepts every pending client
+    void acceptClients();
+
+    // Reads what the client sent; sets peerClosed at end of stream
+    void readInput(Connection& connection);
+
+    // Handles complete requests until the input runs out or output is full
+    void handleRequests(Connection& connection);
+
+    // True if the unhandled input starts with a whole frame
+    static bool hasCompleteFrame(const Connection& connection);
+
+    // Handles a run of POST requests starting at input offset, returns its length
+    size_t handlePostRun(Connection& connection, size_t offset);
+
+    // Handles one non-POST request
+    void handleRequest(Connection& connection, uint32_t tag, uint8_t op, string_view payload);
+
+    // Writes as much pending output as the socket takes
+    void flushOutput(Connection& connection);
+
+    // Registers the events the connection now waits for, or closes it
+    void updateEvents(Connection& connection);
+
+    void closeConnection(int fd);
+
+    // Appends one reply frame
+    void reply(Connection& connection, uint32_t tag, uint8_t status, string_view payload = {});
+    void replyError(Connection& connection, uint32_t tag, uint8_t status, string_view message);
+
+    // Closes every descriptor the server owns
+    void shutdown(const string& socketPath);
+
+public:
+    explicit LedgerServer(ForestTree& tree, ostream& log = cout);
+    ~LedgerServer();
+
+    LedgerServer(const LedgerServer&) = delete;
+    LedgerServer& operator=(const LedgerServer&) = delete;
+
+    bool run(const string& socketPath);  // Serves until stopped
+    void stop();                         // Asks run() to return
+
+    const ServerStats& stats() const { return last; }
+
+    void printStats(ostream& os) const;
+};
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: MappedFile.h
+ * Purpose: Defines the MappedFile class, a read-only memory mapping of a file
+ *          that exposes its contents as a string_view without copying.
+ *
+ * Fields:
+ *  - const char* data: Start of the mapped bytes (nullptr when closed).
+ *  - size_t length: Number of mapped bytes.
+ *
+ * Functions:
+ *  - bool open(const string& filename):
+ *      Maps the whole file read-only. Returns false if it cannot be opened.
+ *  - void close():
+ *      Unmaps the file and releases the underlying handles.
+ *  - string_view contents() const:
+ *      Returns the mapped bytes as a view, valid until close().
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Class: MappedFile
+ * Purpose: Owns a read-only memory mapping of a file. Empty files are valid
+ *          and map to an empty view.
+ */
+class MappedFile {
+private:
+    const char* data;   // Start of the mapped bytes
+    size_t length;      // Number of mapped bytes
+    bool opened;        // True while a file is open
+
+#ifdef _WIN32
+    void* fileHandle;     // HANDLE returned by CreateFile
+    void* mappingHandle;  // HANDLE returned by CreateFileMapping
+#else
+    int fd;               // Descriptor of the mapped file
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const string& filename);  // Maps the file read-only
+    void close();                       // Unmaps the file
+
+    bool isOpen() const { return opened; }
+    size_t size() const { return length; }
+    string_view contents() const { return string_view(data ? data : "", length); }
+};
+
+#endif
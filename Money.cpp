@@ -0,0 +1,101 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: Money.cpp
+ * Purpose: Implements decimal parsing and formatting for the Money class
+ *          with plain digit loops (no locale, no floating point).
+ */
+
+#include "Money.h"
+#include <stdexcept>
+
+// Reports an amount that no longer fits in the representation
+void Money::overflow() {
+    throw overflow_error("Error: Amount is out of range.");
+}
+
+// Parses an optional sign, digits, and up to two decimals
+bool Money::parse(string_view text, Money& result) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < text.size() && (text[i] == '-' || text[i] == '+')) {
+        negative = text[i] == '-';
+        ++i;
+    }
+
+    // Accumulate as a negative number so the most negative value also parses
+    Rep value = 0;
+    int digits = 0;
+    for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i, ++digits) {
+        if (__builtin_mul_overflow(value, Rep(10), &value) ||
+            __builtin_sub_overflow(value, Rep(text[i] - '0'), &value)) {
+            return false;
+        }
+    }
+
+    int decimals = 0;
+    if (i < text.size() && text[i] == '.') {
+        for (++i; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i, ++decimals) {
+            if (decimals == DECIMALS ||
+                __builtin_mul_overflow(value, Rep(10), &value) ||
+                __builtin_sub_overflow(value, Rep(text[i] - '0'), &value)) {
+                return false;  // Too many decimals or too large
+            }
+        }
+    }
+
+    if (i != text.size() || digits + decimals == 0) {
+        return false;  // Trailing characters or no digits at all
+    }
+
+    for (; decimals < DECIMALS; ++decimals) {
+        if (__builtin_mul_overflow(value, Rep(10), &value)) {
+            return false;
+        }
+    }
+
+    if (!negative && __builtin_sub_overflow(Rep(0), value, &value)) {
+        return false;
+    }
+
+    result = fromMinor(value);
+    return true;
+}
+
+// Writes "-123.45" starting at first and returns the end of the text
+char* Money::format(char* first) const {
+    // Work with the non-positive value so the most negative amount is safe
+    Rep value = minor > 0 ? -minor : minor;
+
+    char digits[MAX_CHARS];
+    char* cursor = digits + MAX_CHARS;
+    for (int i = 0; i < DECIMALS; ++i) {
+        *--cursor = static_cast<char>('0' - value % 10);
+        value /= 10;
+    }
+    *--cursor = '.';
+    do {
+        *--cursor = static_cast<char>('0' - value % 10);
+        value /= 10;
+    } while (value != 0);
+    if (minor < 0) {
+        *--cursor = '-';
+    }
+
+    for (; cursor != digits + MAX_CHARS; ++cursor) {
+        *first++ = *cursor;
+    }
+    return first;
+}
+
+// Formats the amount as a string
+string Money::toString() const {
+    char buffer[MAX_CHARS];
+    return string(buffer, format(buffer));
+}
+
+// Writes the formatted amount to a stream
+ostream& operator<<(ostream& os, Money money) {
+    char buffer[Money::MAX_CHARS];
+    return os.write(buffer, money.format(buffer) - buffer);
+}
@@ -0,0 +1,138 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: Money.h
+ * Purpose: Defines the Money class, an exact fixed-point amount stored as an
+ *          integer count of minor units (cents) instead of a double.
+ *
+ * Fields:
+ *  - Rep minor: The amount in minor units. Rep is int64_t, or __int128 when
+ *    the project is compiled with -DCOA_MONEY_128.
+ *
+ * Functions:
+ *  - static Money fromMinor(Rep minor):
+ *      Builds an amount from a count of minor units.
+ *  - static bool parse(string_view text, Money& result):
+ *      Parses "123", "-4.5" or "0.07" exactly. Rejects more than two decimals,
+ *      exponents, stray characters and values that do not fit.
+ *  - char* format(char* first) const:
+ *      Writes the amount as "-123.45" into a buffer of at least MAX_CHARS bytes
+ *      and returns one past the last character written.
+ *  - operator+, operator-, operator+=, operator-=:
+ *      Checked arithmetic; throws overflow_error instead of wrapping.
+ *  - bool canAdd(Money other) const:
+ *      True if *this + other fits, so callers can refuse a change up front
+ *      instead of catching the overflow_error halfway through it.
+ *  - static bool addWide(Wide& sum, Wide amount) / subWide(...):
+ *      Accumulate many amounts in Wide (__int128). With 64-bit Money no
+ *      realistic count of amounts can overflow it and the check is compiled
+ *      out; with 128-bit Money they return false on overflow.
+ *  - static bool fromWide(Wide wide, Money& result):
+ *      Narrows a Wide sum; false if it does not fit in Rep.
+ */
+
+#ifndef MONEY_H
+#define MONEY_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <compare>
+
+using namespace std;
+
+/**
+ * Class: Money
+ * Purpose: Exact currency amount with two decimal places. Sums of any number
+ *          of postings are exact, and comparisons need no epsilon.
+ */
+class Money {
+public:
+#ifdef COA_MONEY_128
+    typedef __int128 Rep;
+    static constexpr size_t MAX_CHARS = 48;  // Sign, 39 digits, point, padding
+#else
+    typedef int64_t Rep;
+    static constexpr size_t MAX_CHARS = 24;  // Sign, 19 digits, point, padding
+#endif
+
+    typedef __int128 Wide;  // Accumulator for sums of many amounts
+
+    static constexpr int DECIMALS = 2;           // Digits after the decimal point
+    static constexpr Rep MINOR_PER_MAJOR = 100;  // Minor units in one major unit
+
+private:
+    Rep minor;  // Amount in minor units
+
+    // Throws overflow_error; kept out of line so the fast paths stay small
+    [[noreturn]] static void overflow();
+
+public:
+    constexpr Money() : minor(0) {}
+
+    static constexpr Money fromMinor(Rep minor) {
+        Money money;
+        money.minor = minor;
+        return money;
+    }
+
+    static bool addWide(Wide& sum, Wide amount) {
+        if constexpr (sizeof(Rep) < sizeof(Wide)) {
+            sum += amount;
+            return true;
+        } else {
+            return !__builtin_add_overflow(sum, amount, &sum);
+        }
+    }
+    static bool subWide(Wide& difference, Wide amount) {
+        if constexpr (sizeof(Rep) < sizeof(Wide)) {
+            difference -= amount;
+            return true;
+        } else {
+            return !__builtin_sub_overflow(difference, amount, &difference);
+        }
+    }
+    static bool fromWide(Wide wide, Money& result) {
+        if (static_cast<Rep>(wide) != wide) {
+            return false;
+        }
+        result = fromMinor(static_cast<Rep>(wide));
+        return true;
+    }
+
+    constexpr Rep minorUnits() const { return minor; }
+    constexpr bool isNegative() const { return minor < 0; }
+    constexpr bool isZero() const { return minor == 0; }
+
+    // Checked arithmetic
+    Money operator+(Money other) const {
+        Rep sum;
+        if (__builtin_add_overflow(minor, other.minor, &sum)) overflow();
+        return fromMinor(sum);
+    }
+    Money operator-(Money other) const {
+        Rep difference;
+        if (__builtin_sub_overflow(minor, other.minor, &difference)) overflow();
+        return fromMinor(difference);
+    }
+    Money operator-() const { return Money() - *this; }
+    Money& operator+=(Money other) { return *this = *this + other; }
+    Money& operator-=(Money other) { return *this = *this - other; }
+    bool canAdd(Money other) const {
+        Rep sum;
+        return !__builtin_add_overflow(minor, other.minor, &sum);
+    }
+
+    constexpr auto operator<=>(const Money&) const = default;
+
+    // Parsing and formatting
+    static bool parse(string_view text, Money& result);
+    char* format(char* first) const;
+    string toString() const;
+
+    friend ostream& operator<<(ostream& os, Money money);
+};
+
+#endif
@@ -0,0 +1,105 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: MpscQueue.h
+ * Purpose: Defines MpscQueue, a bounded lock-free queue with many producers
+ *          and a single consumer, used to feed posting shards.
+ *
+ * Each cell carries a sequence number that tells producers whether it is
+ * free and tells the consumer whether it is filled (D. Vyukov's bounded
+ * queue). Producers claim a position with one compare-and-swap; the single
+ * consumer needs no read-modify-write at all.
+ *
+ * Functions:
+ *  - bool tryPush(const T& value): Enqueues; returns false if the queue is full.
+ *  - bool tryPop(T& value): Dequeues; returns false if the queue is empty.
+ *    Only one thread may call tryPop.
+ *  - bool isEmpty() const: True if tryPop would find nothing right now.
+ *    Only the consumer may call it, e.g. to decide whether to sleep.
+ */
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+using namespace std;
+
+/**
+ * Class: MpscQueue
+ * Purpose: Fixed-capacity multi-producer, single-consumer FIFO.
+ */
+template <typename T>
+class MpscQueue {
+private:
+    struct Cell {
+        atomic<size_t> sequence;  // Position this cell is ready for
+        T value;
+    };
+
+    unique_ptr<Cell[]> cells;
+    size_t mask;                              // Capacity - 1 (capacity is a power of two)
+    alignas(64) atomic<size_t> enqueuePos;    // Next position producers claim
+    alignas(64) size_t dequeuePos;            // Next position the consumer reads
+
+public:
+    // Capacity is rounded up to a power of two
+    explicit MpscQueue(size_t capacity) : enqueuePos(0), dequeuePos(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        cells.reset(new Cell[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; ++i) {
+            cells[i].sequence.store(i, memory_order_relaxed);
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    bool tryPush(const T& value) {
+        size_t pos = enqueuePos.load(memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[pos & mask];
+            size_t sequence = cell->sequence.load(memory_order_acquire);
+            intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (difference == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    break;  // Claimed this cell
+                }
+            } else if (difference < 0) {
+                return false;  // Full: the consumer has not freed this cell yet
+            } else {
+                pos = enqueuePos.load(memory_order_relaxed);  // Another producer won
+            }
+        }
+        cell->value = value;
+        cell->sequence.store(pos + 1, memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& value) {
+        Cell* cell = &cells[dequeuePos & mask];
+        size_t sequence = cell->sequence.load(memory_order_acquire);
+        if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeuePos + 1) < 0) {
+            return false;  // Empty
+        }
+        value = cell->value;
+        cell->sequence.store(dequeuePos + mask + 1, memory_order_release);
+        ++dequeuePos;
+        return true;
+    }
+
+    bool isEmpty() const {
+        size_t sequence = cells[dequeuePos & mask].sequence.load(memory_order_acquire);
+        return static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeuePos + 1) < 0;
+    }
+};
+
+#endif
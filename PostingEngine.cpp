@@ -0,0 +1,276 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: PostingEngine.cpp
+ * Purpose: Implements the sharded, multithreaded PostingEngine.
+ */
+
+#include "PostingEngine.h"
+#include <algorithm>
+#include <mutex>
+
+// Constructor: Links the tree if needed and starts one worker per shard
+PostingEngine::PostingEngine(ForestTree& tree, ShardMode mode, unsigned workers)
+    : tree(tree), mode(mode), stopping(false), submitted(0), rejectedCount(0), outOfRangeCount(0),
+      outOfRangeLines(0), drainBell(0), draining(0) {
+    if (tree.hierarchyDirty) {
+        tree.linkHierarchy();
+    }
+    // Workers write the columns concurrently, so none of them may have to
+    // copy a page that a frozen ledger shares
+    tree.store.columns.makeWritable();
+
+    if (workers == 0) {
+        workers = max(1u, thread::hardware_concurrency());
+    }
+    if (mode == ShardMode::ByClass) {
+        workers = min(workers, 10u);  // One shard per leading digit at most
+    }
+
+    for (unsigned i = 0; i < workers; ++i) {
+        shards.push_back(make_unique<Shard>());
+    }
+    for (auto& shard : shards) {
+        Shard* owned = shard.get();
+        owned->worker = thread([this, owned] { runShard(*owned); });
+    }
+}
+
+// Destructor: Finishes outstanding work before the tree is used again
+PostingEngine::~PostingEngine() {
+    stop();
+}
+
+// Returns an account's top-level class, the leading digit it shares with
+// all of its ancestors
+size_t PostingEngine::classOf(const Account* account) {
+    return static_cast<size_t>(account->number[0] - '0');
+}
+
+// Picks the shard that owns an account
+size_t PostingEngine::shardOf(const Account* account) const {
+    if (mode == ShardMode::ByClass) {
+        return classOf(account) % shards.size();
+    }
+    // Fibonacci hashing spreads consecutive ids across shards
+    return static_cast<size_t>((account->id * 0x9E3779B97F4A7C15ull) >> 32) % shards.size();
+}
+
+// Validates and resolves a posting, then queues it for its shard
+bool PostingEngine::submit(string_view accountNumber, Money amount, char debitCredit, int64_t timestamp) {
+    Account* account = nullptr;
+    if (tree.isValidAccountNumber(accountNumber) && tree.isValidAmount(amount) &&
+        tree.isValidTransactionType(debitCredit)) {
+        account = tree.accounts.find(accountNumber);  // Read-only; safe from many threads
+    }
+    if (account == nullptr) {
+        rejectedCount.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+
+    if (timestamp == Transaction::NO_TIME) {
+        timestamp = Transaction::currentTime();
+    }
+    submitted.fetch_add(1, memory_order_relaxed);
+    Task task;
+    task.posting = Transaction::unchecked(account->id, amount, debitCredit, timestamp);
+    enqueue(task);
+    return true;
+}
+
+// Validates and balances a whole journal entry on the calling thread, then
+// queues it as one task for the shard of its first line, whose worker
+// applies all of its lines or none. Nothing is queued for an entry that is
+// refused.
+bool PostingEngine::submitEntry(const JournalEntry& entry) {
+    auto pending = make_unique<PendingEntry>();
+    int64_t now = Transaction::currentTime();
+    if (tree.stageEntry(entry, now, pending->lines, pending->ids)) {  // Read-only; safe from many threads
+        rejectedCount.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    // The caller's account numbers may not outlive this call; the tree's do
+    for (size_t i = 0; i < pending->lines.size(); ++i) {
+        pending->lines[i].accountNumber = tree.store.at(pending->ids[i])->number;
+    }
+
+    submitted.fetch_add(pending->lines.size(), memory_order_relaxed);
+    Task task;
+    task.entry = pending.release();
+    enqueue(task);
+    return true;
+}
+
+// Queues a task for the shard that owns its (first) account, waking its
+// worker if it is parked
+void PostingEngine::enqueue(const Task& task) {
+    uint32_t id = task.entry ? task.entry->ids.front() : task.posting.accountId;
+    Shard& shard = *shards[shardOf(tree.store.at(id))];
+    while (!shard.queue.tryPush(task)) {
+        this_thread::yield();  // Shard is saturated; let its worker catch up
+    }
+    // Pairs with the fence in park(): either the worker sees this posting
+    // before it sleeps, or this sees it parked
+    atomic_thread_fence(memory_order_seq_cst);
+    if (shard.parked.load(memory_order_relaxed)) {
+        ring(shard.doorbell, false);
+    }
+}
+
+// Bumps a bell and wakes one or all of the threads waiting on it
+void PostingEngine::ring(atomic<uint32_t>& bell, bool everyone) {
+    bell.fetch_add(1, memory_order_seq_cst);
+    if (everyone) {
+        bell.notify_all();
+    } else {
+        bell.notify_one();
+    }
+}
+
+// Applies one posting, or refuses it if a balance, total or roll-up would
+// leave Money's range, as addTransaction does. Every ancestor of the
+// account shares its class, so holding the class lock while the whole chain
+// is checked and written means no other shard sees a roll-up that is later
+// taken back. Returns false if the posting was refused.
+bool PostingEngine::apply(const Transaction& transaction) {
+    Account* account = tree.store.at(transaction.accountId);
+    lock_guard<mutex> hold(classLocks[classOf(account)].lock);
+    if (!account->fitsChange(transaction.signedAmount(), transaction.amount, transaction.isCredit())) {
+        return false;
+    }
+    if (tree.journal) {
+        // Logged under the class lock, so each account's records keep apply order
+        tree.journal->logPosting(account->number, transaction.amount, transaction.debitCredit(),
+                                 transaction.timestamp);
+    }
+    account->addTransaction(transaction);
+    return true;
+}
+
+// Applies every line of an entry, or none if a balance, total or roll-up
+// would leave Money's range. The entry is staged and checked as a whole,
+// as postEntry does, with every class it touches locked (lowest digit
+// first, so two entries cannot deadlock), and journaled as one record.
+// Returns false if the entry was refused.
+bool PostingEngine::applyEntry(const PendingEntry& entry) {
+    bool touched[10] = {};
+    for (uint32_t id : entry.ids) {
+        touched[classOf(tree.store.at(id))] = true;
+    }
+    lock_guard<mutex> staging(entryLock);  // stagePostings uses the tree's scratch space
+    for (size_t digit = 0; digit < 10; ++digit) {
+        if (touched[digit]) {
+            classLocks[digit].lock.lock();
+        }
+    }
+
+    bool fits = tree.stagePostings(entry.lines, entry.ids);
+    if (fits) {
+        if (tree.journal) {
+            tree.journal->logEntry(entry.lines, entry.lines.front().timestamp);
+        }
+        tree.commitPostings(entry.lines, entry.ids, false);
+    }
+
+    for (size_t digit = 10; digit-- > 0;) {
+        if (touched[digit]) {
+            classLocks[digit].lock.unlock();
+        }
+    }
+    return fits;
+}
+
+// Worker loop: spins briefly when idle, then parks until rung
+void PostingEngine::runShard(Shard& shard) {
+    Task task;
+    unsigned idle = 0;
+    for (;;) {
+        if (shard.queue.tryPop(task)) {
+            size_t lines = 1;
+            if (task.entry) {
+                unique_ptr<PendingEntry> entry(task.entry);
+                lines = entry->lines.size();
+                if (!applyEntry(*entry)) {
+                    outOfRangeCount.fetch_add(1, memory_order_relaxed);
+                    outOfRangeLines.fetch_add(lines, memory_order_relaxed);
+                }
+            } else if (!apply(task.posting)) {
+                outOfRangeCount.fetch_add(1, memory_order_relaxed);
+                outOfRangeLines.fetch_add(1, memory_order_relaxed);
+            }
+            // Both seq_cst, so a drain() that starts after the load below
+            // sees this count, and one that started before is rung
+            shard.applied.fetch_add(lines, memory_order_seq_cst);
+            if (draining.load(memory_order_seq_cst) != 0) {
+                ring(drainBell, true);
+            }
+            idle = 0;
+        } else if (stopping.load(memory_order_acquire)) {
+            return;  // stop() drains first, so nothing is left behind
+        } else if (++idle > IDLE_SPINS) {
+            park(shard);
+            idle = 0;
+        }
+    }
+}
+
+// Sleeps on the shard's doorbell unless a posting arrived or the engine is
+// stopping. The ticket is read first, so a ring after it ends the wait.
+void PostingEngine::park(Shard& shard) {
+    uint32_t ticket = shard.doorbell.load(memory_order_acquire);
+    shard.parked.store(true, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);  // Pairs with the fence in enqueue()
+    if (shard.queue.isEmpty() && !stopping.load(memory_order_acquire)) {
+        shard.doorbell.wait(ticket, memory_order_acquire);
+    }
+    shard.parked.store(false, memory_order_relaxed);
+}
+
+// Sums the per-shard counters of postings taken off the queues
+size_t PostingEngine::handled() const {
+    size_t total = 0;
+    for (const auto& shard : shards) {
+        total += shard->applied.load(memory_order_seq_cst);
+    }
+    return total;
+}
+
+// Sums the per-shard counters, less the postings the workers refused
+size_t PostingEngine::posted() const {
+    return handled() - outOfRangeLines.load(memory_order_acquire);
+}
+
+// Blocks until every posting submitted before the call has been applied
+// (or refused by apply()), sleeping on drainBell in between
+void PostingEngine::drain() {
+    size_t target = submitted.load(memory_order_relaxed);
+    if (handled() >= target) {
+        return;
+    }
+    draining.fetch_add(1, memory_order_seq_cst);
+    for (;;) {
+        uint32_t ticket = drainBell.load(memory_order_seq_cst);
+        if (handled() >= target) {
+            break;
+        }
+        drainBell.wait(ticket, memory_order_seq_cst);
+    }
+    draining.fetch_sub(1, memory_order_relaxed);
+}
+
+// Drains the queues and joins the workers
+void PostingEngine::stop() {
+    if (stopping.load()) {
+        return;
+    }
+    drain();
+    stopping.store(true, memory_order_release);
+    for (auto& shard : shards) {
+        ring(shard->doorbell, false);  // A parked worker sees stopping and exits
+    }
+    for (auto& shard : shards) {
+        if (shard->worker.joinable()) {
+            shard->worker.join();
+        }
+    }
+}
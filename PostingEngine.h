@@ -0,0 +1,151 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: PostingEngine.h
+ * Purpose: Defines the PostingEngine class, a concurrent posting mode for a
+ *          ForestTree. Accounts are split into shards, each shard is owned by
+ *          one worker thread, and any number of producer threads feed the
+ *          shards through lock-free MPSC queues.
+ *
+ * Sharding:
+ *  - ShardMode::ByClass: by top-level class (the first digit, 1-8 in the
+ *    chart). All ancestors of an account share its class, so a class never
+ *    contends with another, but at most ten workers are useful.
+ *  - ShardMode::ByHash: by a hash of the account id. Spreads load over any
+ *    number of workers; ancestors are shared between shards.
+ *
+ * Every account belongs to exactly one shard. An account and all of its
+ * ancestors share a class, so a worker checks and applies a posting under
+ * its class's lock: the roll-ups of a class change one whole posting at a
+ * time, and a posting that would overflow is refused before anything is
+ * written. ByClass shards never wait on each other for these locks; ByHash
+ * shards do when they post to the same class.
+ *
+ * A worker whose queue stays empty for IDLE_SPINS polls parks on its
+ * shard's doorbell (atomic wait), and a producer that queues to a parked
+ * shard rings it, so idle shards use no CPU. drain() sleeps on a bell of
+ * its own that workers ring while someone is draining.
+ *
+ * Functions:
+ *  - bool submit(string_view accountNumber, Money amount, char debitCredit,
+ *                int64_t timestamp):
+ *      Validates and resolves the posting on the calling thread and queues
+ *      it for its shard, stamped with the current time unless timestamp is
+ *      given. Safe to call from many threads at once.
+ *  - bool submitEntry(const JournalEntry& entry):
+ *      Checks that the whole entry is valid and balances, then queues it as
+ *      one task for the shard of its first line, or refuses the entry
+ *      without queuing anything. The worker locks every class the entry
+ *      touches, stages and range-checks all of its lines as postEntry does,
+ *      and applies and journals them as one record, or refuses them all.
+ *  - void drain():
+ *      Blocks until every posting submitted so far has been applied.
+ *  - size_t posted() const / size_t rejected() const:
+ *      Postings (entry lines included) applied, and postings or entries
+ *      refused: on submission for bad input, or by the worker when a
+ *      balance, total or roll-up would leave Money's range.
+ *  - void stop():
+ *      Drains and joins the workers. Also called by the destructor.
+ *
+ * While the engine runs, the tree must not be modified or frozen through any
+ * other path, and balances are only guaranteed to be complete after drain().
+ */
+
+#ifndef POSTING_ENGINE_H
+#define POSTING_ENGINE_H
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <string_view>
+#include <cstddef>
+#include "ForestTree.h"
+#include "MpscQueue.h"
+
+using namespace std;
+
+enum class ShardMode { ByClass, ByHash };
+
+/**
+ * Class: PostingEngine
+ * Purpose: Applies postings to a ForestTree on per-shard worker threads.
+ */
+class PostingEngine {
+private:
+    static constexpr size_t QUEUE_CAPACITY = 1 << 16;  // Postings buffered per shard
+    static constexpr unsigned IDLE_SPINS = 128;        // Empty polls before a worker parks
+
+    // A checked entry waiting for its worker, with its lines stamped and
+    // pointed at the tree's account numbers
+    struct PendingEntry {
+        vector<Posting> lines;
+        vector<uint32_t> ids;
+    };
+
+    // One queued posting, or a whole entry if entry is set (the worker
+    // deletes it)
+    struct Task {
+        Transaction posting;
+        PendingEntry* entry = nullptr;
+    };
+
+    // One worker thread with its queue
+    struct Shard {
+        MpscQueue<Task> queue;
+        thread worker;
+        alignas(64) atomic<size_t> applied;  // Postings and entry lines this shard has applied or refused
+        alignas(64) atomic<uint32_t> doorbell;  // Bumped to wake the parked worker
+        atomic<bool> parked;                    // The worker is (about to be) waiting on doorbell
+
+        Shard() : queue(QUEUE_CAPACITY), applied(0), doorbell(0), parked(false) {}
+    };
+
+    // Serializes the postings of one top-level class
+    struct alignas(64) ClassLock {
+        mutex lock;
+    };
+
+    ForestTree& tree;
+    ShardMode mode;
+    vector<unique_ptr<Shard>> shards;
+    atomic<bool> stopping;                // Tells idle workers to exit
+    alignas(64) atomic<size_t> submitted; // Postings queued so far
+    atomic<size_t> rejectedCount;         // Postings refused by submit()
+    atomic<size_t> outOfRangeCount;       // Postings and entries refused by the workers
+    atomic<size_t> outOfRangeLines;       // Postings and entry lines refused by the workers
+    alignas(64) atomic<uint32_t> drainBell;  // Bumped by workers while drain() waits
+    atomic<unsigned> draining;               // Threads waiting in drain()
+    ClassLock classLocks[10];                // One per leading digit
+    mutex entryLock;                         // Held while an entry is staged and committed
+
+    static size_t classOf(const Account* account); // Leading digit of an account number
+    size_t shardOf(const Account* account) const;  // Shard owning an account
+    void runShard(Shard& shard);                   // Worker loop
+    void park(Shard& shard);                       // Sleeps until the shard has work or the engine stops
+    static void ring(atomic<uint32_t>& bell, bool everyone);  // Wakes threads waiting on a bell
+    bool apply(const Transaction& transaction);    // Applies one posting unless a total would overflow
+    bool applyEntry(const PendingEntry& entry);    // Applies a whole entry unless a total would overflow
+    size_t handled() const;                        // Postings taken off the queues so far
+    void enqueue(const Task& task);                // Pushes a posting or entry to its shard
+
+public:
+    PostingEngine(ForestTree& tree, ShardMode mode = ShardMode::ByHash, unsigned workers = 0);
+    ~PostingEngine();
+
+    PostingEngine(const PostingEngine&) = delete;
+    PostingEngine& operator=(const PostingEngine&) = delete;
+
+    bool submit(string_view accountNumber, Money amount, char debitCredit,
+                int64_t timestamp = Transaction::NO_TIME);  // Queues a posting
+    bool submitEntry(const JournalEntry& entry);  // Queues a balanced entry, all lines or none
+    void drain();  // Waits for every submitted posting
+    void stop();   // Drains and joins the workers
+
+    size_t shardCount() const { return shards.size(); }
+    size_t posted() const;                                     // Postings applied so far
+    size_t rejected() const { return rejectedCount.load() + outOfRangeCount.load(); }  // Postings and entries refused
+};
+
+#endif
@@ -0,0 +1,112 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: PostingTimeIndex.cpp
+ * Purpose: Implements building, extending and querying the per-account
+ *          Fenwick tree of postings ordered by time.
+ */
+
+#include "PostingTimeIndex.h"
+#include <algorithm>
+
+using namespace std;
+
+// Walks down the Fenwick tree: O(log n). False if the sum does not fit.
+bool PostingTimeIndex::prefix(size_t count, Money::Wide& total) const {
+    total = 0;
+    bool fits = true;
+    for (size_t i = count; i > 0; i &= i - 1) {
+        fits &= Money::addWide(total, sums[i - 1]);
+    }
+    return fits;
+}
+
+// Walks up the Fenwick tree: O(log n)
+void PostingTimeIndex::add(size_t position, Money::Wide amount) {
+    for (size_t i = position + 1; i <= sums.size(); i += i & (0 - i)) {
+        overflowed |= !Money::addWide(sums[i - 1], amount);
+    }
+}
+
+// Sorts the live postings by time (stable, so ties keep posting order) and
+// builds the tree bottom-up in O(n): each node passes its range total on to
+// the next node that covers it.
+void PostingTimeIndex::build(const vector<Transaction>& transactions, size_t sequenceCount) {
+    vector<uint32_t> slots;
+    slots.reserve(transactions.size());
+    for (uint32_t slot = 0; slot < transactions.size(); ++slot) {
+        if (!transactions[slot].isDeleted()) {
+            slots.push_back(slot);
+        }
+    }
+    stable_sort(slots.begin(), slots.end(), [&](uint32_t a, uint32_t b) {
+        return transactions[a].timestamp < transactions[b].timestamp;
+    });
+
+    size_t n = slots.size();
+    times.resize(n);
+    sums.resize(n);
+    overflowed = false;
+    positionBySequence.assign(sequenceCount, NO_POSITION);
+    for (size_t i = 0; i < n; ++i) {
+        const Transaction& transaction = transactions[slots[i]];
+        times[i] = transaction.timestamp;
+        sums[i] = transaction.signedAmount().minorUnits();
+        positionBySequence[transaction.sequence()] = static_cast<uint32_t>(i);
+    }
+    for (size_t i = 1; i <= n; ++i) {
+        size_t parent = i + (i & (0 - i));
+        if (parent <= n) {
+            overflowed |= !Money::addWide(sums[parent - 1], sums[i - 1]);
+        }
+    }
+}
+
+// Appends a posting at the end of the time order. The new node covers
+// positions (i - lowbit(i), i], which is its own amount plus the range
+// (i - lowbit(i), i - 1] read as a difference of two prefixes.
+bool PostingTimeIndex::append(const Transaction& transaction) {
+    if (!times.empty() && transaction.timestamp < times.back()) {
+        return false;
+    }
+    size_t i = times.size() + 1;
+    Money::Wide node, before;
+    overflowed |= !prefix(i - 1, node) || !prefix(i - (i & (0 - i)), before) || !Money::subWide(node, before) ||
+                  !Money::addWide(node, transaction.signedAmount().minorUnits());
+    times.push_back(transaction.timestamp);
+    sums.push_back(node);
+    if (positionBySequence.size() <= transaction.sequence()) {
+        positionBySequence.resize(transaction.sequence() + 1, NO_POSITION);
+    }
+    positionBySequence[transaction.sequence()] = static_cast<uint32_t>(i - 1);
+    return true;
+}
+
+// Cancels a deleted posting's amount at its position
+void PostingTimeIndex::remove(const Transaction& transaction) {
+    uint32_t sequence = transaction.sequence();
+    if (sequence < positionBySequence.size() && positionBySequence[sequence] != NO_POSITION) {
+        add(positionBySequence[sequence], -Money::Wide(transaction.signedAmount().minorUnits()));
+        positionBySequence[sequence] = NO_POSITION;
+    }
+}
+
+// Binary search for the last posting at or before time, then one prefix sum
+bool PostingTimeIndex::balanceAsOf(int64_t time, Money& balance) const {
+    size_t count = upper_bound(times.begin(), times.end(), time) - times.begin();
+    Money::Wide total;
+    return !overflowed && prefix(count, total) && Money::fromWide(total, balance);
+}
+
+// Difference of two prefixes: postings with from <= timestamp <= to
+bool PostingTimeIndex::movementBetween(int64_t from, int64_t to, Money& movement) const {
+    if (from > to) {
+        movement = Money();
+        return true;
+    }
+    size_t first = lower_bound(times.begin(), times.end(), from) - times.begin();
+    size_t last = upper_bound(times.begin() + first, times.end(), to) - times.begin();
+    Money::Wide total, before;
+    return !overflowed && prefix(last, total) && prefix(first, before) && Money::subWide(total, before) &&
+           Money::fromWide(total, movement);
+}
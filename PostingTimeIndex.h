@@ -0,0 +1,80 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: PostingTimeIndex.h
+ * Purpose: Defines the PostingTimeIndex class, which orders one account's
+ *          postings by timestamp and keeps a Fenwick (binary indexed) tree of
+ *          their signed amounts, so balances at a point in time are answered
+ *          without rescanning the transaction vector.
+ *
+ * Fields:
+ *  - vector<int64_t> times: Timestamps of the indexed postings, ascending.
+ *    Equal timestamps keep posting order.
+ *  - vector<Money::Wide> sums: Fenwick tree over the signed amounts in times
+ *    order; sums[i - 1] covers positions (i - lowbit(i), i]. Postings taken
+ *    in time rather than posting order can add up past Money's range, so
+ *    the sums are kept wide and only a query's result is range-checked.
+ *  - bool overflowed: A node sum left Wide's range (only possible with
+ *    128-bit Money); every query fails until the index is rebuilt.
+ *  - vector<uint32_t> positionBySequence: Position of each posting (by its
+ *    sequence number) in times, so a deletion finds its entry in O(1).
+ *
+ * Functions:
+ *  - void build(const vector<Transaction>& transactions, size_t sequenceCount):
+ *      Indexes every live posting in O(n log n).
+ *  - bool append(const Transaction& transaction):
+ *      Adds a posting in O(log n) if it is not older than the newest one
+ *      indexed; returns false otherwise, and the index must be rebuilt.
+ *  - void remove(const Transaction& transaction):
+ *      Takes a deleted posting's amount out in O(log n). Its timestamp stays
+ *      in times with a zero contribution.
+ *  - bool balanceAsOf(int64_t time, Money& balance) const:
+ *      Sum of the signed amounts posted at or before time, in O(log n).
+ *      Returns false if the sum is out of Money's range.
+ *  - bool movementBetween(int64_t from, int64_t to, Money& movement) const:
+ *      Sum of the signed amounts posted from from to to inclusive, or false
+ *      if it is out of range.
+ */
+
+#ifndef POSTING_TIME_INDEX_H
+#define POSTING_TIME_INDEX_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "Transaction.h"
+#include "Money.h"
+
+using namespace std;
+
+/**
+ * Class: PostingTimeIndex
+ * Purpose: Time-ordered prefix sums over one account's postings.
+ */
+class PostingTimeIndex {
+private:
+    static constexpr uint32_t NO_POSITION = UINT32_MAX;  // Posting was never indexed
+
+    vector<int64_t> times;
+    vector<Money::Wide> sums;
+    vector<uint32_t> positionBySequence;
+    bool overflowed = false;
+
+    // Sum of the first count positions; false if it does not fit
+    bool prefix(size_t count, Money::Wide& total) const;
+
+    // Adds amount at position (0-based) and every range that covers it
+    void add(size_t position, Money::Wide amount);
+
+public:
+    void build(const vector<Transaction>& transactions, size_t sequenceCount);
+    bool append(const Transaction& transaction);
+    void remove(const Transaction& transaction);
+
+    bool balanceAsOf(int64_t time, Money& balance) const;
+    bool movementBetween(int64_t from, int64_t to, Money& movement) const;
+
+    size_t size() const { return times.size(); }
+};
+
+#endif
@@ -0,0 +1,89 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: ReportWriter.cpp
+ * Purpose: Implements the hierarchy report on top of ReportWriter's buffer.
+ */
+
+#include "ReportWriter.h"
+#include "Account.h"
+#include <utility>
+#include <string>
+
+using namespace std;
+
+// Constructor: Allocates the buffer once for the whole report
+ReportWriter::ReportWriter(ostream& out, size_t capacity)
+    : out(&out), target(nullptr), buffer(capacity), used(0) {}
+
+// Constructor: Renders into a string instead of a stream
+ReportWriter::ReportWriter(string& target, size_t capacity)
+    : out(nullptr), target(&target), buffer(capacity), used(0) {}
+
+// Destructor: Writes out whatever is left
+ReportWriter::~ReportWriter() {
+    flush();
+}
+
+// Hands the buffered text to the stream (or string) in one call
+void ReportWriter::flush() {
+    if (used > 0) {
+        if (out) {
+            out->write(buffer.data(), static_cast<streamsize>(used));
+        } else {
+            target->append(buffer.data(), used);
+        }
+        used = 0;
+    }
+}
+
+// Writes root and its descendants in pre-order. Each account line is
+//   <indent>number - description (Balance: $rollup)
+// followed, if enabled, by its live transactions two levels deeper, in the
+// same "Account, Amount, Type, Date" form as Transaction's operator<<.
+void ReportWriter::writeHierarchy(const Account* root, int level, const ReportOptions& options) {
+    vector<pair<const Account*, int>> stack;
+    string prefix;  // Start of the current account's posting lines
+    stack.emplace_back(root, level);
+    while (!stack.empty()) {
+        auto [account, depth] = stack.back();
+        stack.pop_back();
+
+        appendIndent(depth);
+        append(account->number);
+        append(" - ");
+        append(account->description());
+        append(" (Balance: $");
+        appendMoney(account->rollupBalance());
+        append(")\n");
+
+        if (options.includePostings && account->liveTransactionCount() > 0) {
+            appendIndent(depth + 1);
+            append("Transactions:\n");
+
+            // Every posting line of an account starts the same way, so the
+            // prefix is built once and each line is a few copies and two formats
+            prefix.assign(static_cast<size_t>(depth + 2) * INDENT, ' ');
+            prefix.append("Account: ").append(account->number).append(", Amount: ");
+            for (const Transaction& transaction : account->transactions) {
+                if (transaction.isDeleted()) {
+                    continue;
+                }
+                string_view type = transaction.isCredit() ? ", Type: Credit, Date: " : ", Type: Debit, Date: ";
+                char* cursor = reserve(prefix.size() + Money::MAX_CHARS + type.size() + Transaction::TIME_CHARS + 1);
+                cursor = copy(prefix.begin(), prefix.end(), cursor);
+                cursor = transaction.amount.format(cursor);
+                cursor = copy(type.begin(), type.end(), cursor);
+                cursor = Transaction::formatTime(transaction.timestamp, cursor);
+                *cursor++ = '\n';
+                used = cursor - buffer.data();
+            }
+        }
+
+        if (options.maxDepth < 0 || depth < options.maxDepth) {
+            for (auto it = account->children.rbegin(); it != account->children.rend(); ++it) {
+                stack.emplace_back(*it, depth + 1);
+            }
+        }
+    }
+}
@@ -0,0 +1,144 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: ReportWriter.h
+ * Purpose: Defines the ReportWriter class, which formats the account
+ *          hierarchy report into one large reusable buffer and hands it to
+ *          the output stream in a few big writes.
+ *
+ * Fields:
+ *  - ostream* out / string* target: Destination of the report, a stream or
+ *    an in-memory string (used to render classes in parallel).
+ *  - vector<char> buffer / size_t used: Pending output. It is written out
+ *    whenever the next piece would not fit.
+ *
+ * Functions:
+ *  - void writeHierarchy(const Account* root, int level, const ReportOptions& options):
+ *      Writes root and its descendants, walking the tree with an explicit
+ *      stack. The output matches Account::printHierarchy.
+ *  - void append(string_view text), appendIndent(int level), appendMoney(Money amount),
+ *    appendMoney(Money amount, size_t width), appendNumber(uint64_t value),
+ *    appendCsvField(string_view text):
+ *      Low-level formatting straight into the buffer.
+ *  - void flush():
+ *      Writes out whatever is buffered.
+ */
+
+#ifndef REPORT_WRITER_H
+#define REPORT_WRITER_H
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include "Money.h"
+
+using namespace std;
+
+class Account;
+
+/**
+ * Struct: ReportOptions
+ * Purpose: What a hierarchy report includes.
+ */
+struct ReportOptions {
+    int maxDepth = -1;             // Deepest level written (roots are level 0); -1 for all
+    bool includePostings = true;   // Write each account's live transactions
+    unsigned threads = 0;          // Render threads; 0 for one per core, 1 for none
+    bool filePerClass = false;     // Write each root to "<stem>_<number><ext>" instead
+};
+
+/**
+ * Class: ReportWriter
+ * Purpose: Buffered, locale-free report formatting.
+ */
+class ReportWriter {
+private:
+    ostream* out;
+    string* target;
+    vector<char> buffer;
+    size_t used;
+
+    // Makes room for length more bytes, writing the buffer out if needed
+    char* reserve(size_t length) {
+        if (buffer.size() - used < length) {
+            flush();
+            if (buffer.size() < length) {
+                buffer.resize(length);
+            }
+        }
+        return buffer.data() + used;
+    }
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 20;
+    static constexpr int INDENT = 4;  // Spaces per hierarchy level
+
+    explicit ReportWriter(ostream& out, size_t capacity = DEFAULT_CAPACITY);
+    explicit ReportWriter(string& target, size_t capacity = DEFAULT_CAPACITY);
+    ~ReportWriter();
+
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+
+    void append(string_view text) {
+        char* cursor = reserve(text.size());
+        text.copy(cursor, text.size());
+        used += text.size();
+    }
+
+    void appendIndent(int level) {
+        size_t width = static_cast<size_t>(level) * INDENT;
+        char* cursor = reserve(width);
+        fill(cursor, cursor + width, ' ');
+        used += width;
+    }
+
+    void appendMoney(Money amount) {
+        char* cursor = reserve(Money::MAX_CHARS);
+        used = amount.format(cursor) - buffer.data();
+    }
+
+    void appendPadding(size_t width) {
+        char* cursor = reserve(width);
+        fill(cursor, cursor + width, ' ');
+        used += width;
+    }
+
+    // Right-aligns the amount in a column of width characters
+    void appendMoney(Money amount, size_t width) {
+        char text[Money::MAX_CHARS];
+        size_t length = amount.format(text) - text;
+        appendPadding(width > length ? width - length : 0);
+        append(string_view(text, length));
+    }
+
+    void appendNumber(uint64_t value) {
+        char* cursor = reserve(20);
+        used = to_chars(cursor, cursor + 20, value).ptr - buffer.data();
+    }
+
+    // Writes a CSV field, quoted only if it contains a separator, quote or newline
+    void appendCsvField(string_view text) {
+        if (text.find_first_of(",\"\r\n") == string_view::npos) {
+            append(text);
+            return;
+        }
+        append("\"");
+        for (size_t quote; (quote = text.find('"')) != string_view::npos; text.remove_prefix(quote + 1)) {
+            append(text.substr(0, quote + 1));
+            append("\"");
+        }
+        append(text);
+        append("\"");
+    }
+
+    void writeHierarchy(const Account* root, int level, const ReportOptions& options = ReportOptions());
+    void flush();
+};
+
+#endif
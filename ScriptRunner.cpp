@@ -0,0 +1,287 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: ScriptRunner.cpp
+ * Purpose: Implements the ScriptRunner class. Each line is split into
+ *          string_view tokens, run against the tree with cout redirected
+ *          into a capture buffer, and answered with one tab-separated
+ *          result line.
+ */
+
+#include "ScriptRunner.h"
+#include "TransactionImporter.h"
+#include <fstream>
+#include <chrono>
+#include <charconv>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+// Returns true for the whitespace characters between tokens (and at the
+// end of captured messages)
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Removes leading and trailing blanks without copying
+string_view trim(string_view text) {
+    size_t begin = 0;
+    size_t end = text.size();
+    while (begin < end && isBlank(text[begin])) ++begin;
+    while (end > begin && isBlank(text[end - 1])) --end;
+    return text.substr(begin, end - begin);
+}
+
+// Takes the next blank-separated token off the front of rest
+string_view nextToken(string_view& rest) {
+    rest = trim(rest);
+    size_t end = 0;
+    while (end < rest.size() && !isBlank(rest[end])) ++end;
+    string_view token = rest.substr(0, end);
+    rest.remove_prefix(end);
+    return token;
+}
+
+// Points cout and cerr at a capture buffer for as long as it lives, so the
+// console streams come back even when a command throws
+class CaptureStreams {
+private:
+    streambuf* console;
+    streambuf* errors;
+
+public:
+    explicit CaptureStreams(ostream& capture)
+        : console(cout.rdbuf(capture.rdbuf())), errors(cerr.rdbuf(capture.rdbuf())) {}
+    ~CaptureStreams() {
+        cerr.rdbuf(errors);
+        cout.rdbuf(console);
+    }
+
+    CaptureStreams(const CaptureStreams&) = delete;
+    CaptureStreams& operator=(const CaptureStreams&) = delete;
+};
+
+// Picks the financial report format from the file extension
+FinancialReportOptions reportOptionsFor(const string& filename) {
+    FinancialReportOptions options;
+    if (filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".csv") == 0) {
+        options.format = ReportFormat::Csv;
+    }
+    return options;
+}
+
+} // namespace
+
+// Constructor: Binds the runner to a tree and its output streams
+ScriptRunner::ScriptRunner(ForestTree& tree, ostream& out, ostream& log)
+    : tree(tree), out(out), log(log), headerWritten(false) {}
+
+// Opens the script, or uses standard input for "-"
+bool ScriptRunner::runFile(const string& filename) {
+    if (filename == "-") {
+        run(cin);
+        return true;
+    }
+    ifstream script(filename);
+    if (!script.is_open()) {
+        log << "Error: Could not open file " << filename << endl;
+        return false;
+    }
+    run(script);
+    return true;
+}
+
+// Runs one command per line. The tree reports failures by printing
+// "Error: ..." (accounts on cerr), so both streams are captured around
+// each command and the text becomes the result. A command that throws is
+// reported as an error with the exception's message, and the script goes on.
+void ScriptRunner::run(istream& in) {
+    if (!headerWritten) {
+        out << "line\tstatus\tmicros\tresult" << endl;
+        headerWritten = true;
+    }
+
+    string line;
+    string result;
+    size_t lineNumber = 0;
+    while (getline(in, line)) {
+        ++lineNumber;
+        string_view rest = trim(line);
+        if (rest.empty() || rest[0] == '#') {
+            continue;
+        }
+        string_view command = nextToken(rest);
+
+        result.clear();
+        captured.str("");
+        auto start = chrono::steady_clock::now();
+        bool ok;
+        bool threw = false;
+        try {
+            CaptureStreams capture(captured);
+            ok = execute(command, rest, result);
+        } catch (const exception& error) {
+            ok = false;
+            threw = true;
+            result = *error.what() ? error.what() : "The command failed.";
+        }
+        double micros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+
+        string_view printed = trim(captured.view());
+        if (threw) {
+            if (result.compare(0, 7, "Error: ") == 0) {
+                result.erase(0, 7);
+            }
+        } else if (printed.substr(0, 7) == "Error: ") {
+            ok = false;
+            result = printed.substr(7);
+        } else if (result.empty()) {
+            result = printed;
+        }
+        replace(result.begin(), result.end(), '\n', ' ');
+
+        ++last.commands;
+        last.errors += ok ? 0 : 1;
+        last.seconds += micros / 1e6;
+        last.latencies.push_back(static_cast<float>(micros));
+        out << lineNumber << '\t' << (ok ? "ok" : "error") << '\t'
+            << static_cast<size_t>(micros + 0.5) << '\t' << result << '\n';
+
+        // Answer a pipe at once; let a script file fill the output buffer
+        if (in.rdbuf()->in_avail() <= 0) {
+            out.flush();
+        }
+    }
+    out.flush();
+}
+
+// Parses the arguments of one command and calls the tree
+bool ScriptRunner::execute(string_view command, string_view arguments, string& result) {
+    string_view rest = arguments;
+    if (command == "add") {
+        string number(nextToken(rest));
+        tree.addAccount(number, string(trim(rest)));
+    } else if (command == "post") {
+        string number(nextToken(rest));
+        string_view amountText = nextToken(rest);
+        string_view type = nextToken(rest);
+        string_view date = trim(rest);
+        Money amount;
+        int64_t time = Transaction::NO_TIME;
+        if (!Money::parse(amountText, amount)) {
+            result = "Invalid amount.";
+            return false;
+        }
+        if (!date.empty() && !Transaction::parseTime(date, time, false)) {
+            result = "Invalid date.";
+            return false;
+        }
+        tree.addTransaction(number, amount, type.size() == 1 ? type[0] : '\0', time);
+    } else if (command == "delete") {
+        string number(nextToken(rest));
+        string_view idText = trim(rest);
+        int id = 0;
+        auto [parsed, error] = from_chars(idText.data(), idText.data() + idText.size(), id);
+        if (error != errc() || parsed != idText.data() + idText.size()) {
+            result = "Invalid transaction ID.";
+            return false;
+        }
+        tree.deleteTransaction(number, id);
+    } else if (command == "search") {
+        string number(trim(rest));
+        Account* account = tree.searchAccount(number);
+        if (!account) {
+            result = "Account not found.";
+            return false;
+        }
+        result.append(account->number).append("\t").append(account->description()).append("\t")
+              .append(account->balance().toString()).append("\t").append(account->rollupBalance().toString());
+    } else if (command == "balance") {
+        string number(nextToken(rest));
+        string_view date = trim(rest);
+        int64_t time;
+        if (date.empty()) {
+            Account* account = tree.searchAccount(number);
+            if (!account) {
+                result = "Account not found.";
+                return false;
+            }
+            result = account->rollupBalance().toString();
+        } else if (!Transaction::parseTime(date, time, true)) {
+            result = "Invalid date.";
+            return false;
+        } else {
+            Money balance;
+            if (!tree.balanceAsOf(number, time, balance)) {
+                return false;
+            }
+            result = balance.toString();
+        }
+    } else if (command == "movement") {
+        string number(nextToken(rest));
+        string_view fromText = nextToken(rest);
+        string_view toText = trim(rest);
+        int64_t from, to;
+        if (!Transaction::parseTime(fromText, from, false) || !Transaction::parseTime(toText, to, true)) {
+            result = "Invalid date.";
+            return false;
+        }
+        Money movement;
+        if (!tree.movementBetween(number, from, to, movement)) {
+            return false;
+        }
+        result = movement.toString();
+    } else if (command == "details") {
+        string number(nextToken(rest));
+        tree.printAccountDetails(number, string(trim(rest)));
+    } else if (command == "tree") {
+        tree.printForestTree(string(trim(rest)));
+    } else if (command == "trial" || command == "balancesheet" || command == "income") {
+        string filename(trim(rest));
+        if (command == "trial") {
+            tree.printTrialBalance(filename, reportOptionsFor(filename));
+        } else if (command == "balancesheet") {
+            tree.printBalanceSheet(filename, reportOptionsFor(filename));
+        } else {
+            tree.printIncomeStatement(filename, reportOptionsFor(filename));
+        }
+    } else if (command == "import") {
+        string filename(trim(rest));
+        TransactionImporter importer(tree, cout);
+        if (importer.importFile(filename, filename + ".rejects")) {
+            importer.printStats(cout);
+        }
+    } else {
+        result = "Unknown command \"" + string(command) + "\".";
+        return false;
+    }
+    return true;
+}
+
+// Writes a one-line summary of the commands run, including latency
+// percentiles
+void ScriptRunner::printStats(ostream& os) const {
+    os << "Ran " << last.commands << " commands";
+    if (last.errors > 0) {
+        os << " (" << last.errors << " failed)";
+    }
+    os << " in " << last.seconds * 1000.0 << " ms: " << static_cast<size_t>(last.commandsPerSecond())
+       << " commands/s";
+    if (!last.latencies.empty()) {
+        vector<float> sorted(last.latencies);
+        auto percentile = [&](double fraction) {
+            size_t rank = min(sorted.size() - 1, static_cast<size_t>(fraction * sorted.size()));
+            nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+            return sorted[rank];
+        };
+        ios::fmtflags flags = os.flags();
+        streamsize precision = os.precision(1);
+        os << fixed << ", latency p50 " << percentile(0.50) << " us, p99 " << percentile(0.99)
+           << " us, max " << *max_element(sorted.begin(), sorted.end()) << " us";
+        os.flags(flags);
+        os.precision(precision);
+    }
+    os << "\n";
+}
@@ -0,0 +1,105 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: ScriptRunner.h
+ * Purpose: Defines the ScriptRunner class, which runs ledger commands from a
+ *          script file or a pipe without prompts and writes one
+ *          machine-readable result line per command.
+ *
+ * Commands (one per line; blank lines and lines starting with '#' are
+ * skipped; the last argument of each command is the rest of the line):
+ *  - add <number> <description>            Adds an account.
+ *  - post <number> <amount> <D|C> [<date>] Adds a transaction, stamped now
+ *                                          unless a date is given.
+ *  - delete <number> <id>                  Deletes a transaction by ID.
+ *  - search <number>                       Result: number, description,
+ *                                          balance and roll-up balance.
+ *  - balance <number> [<date>]             Roll-up balance, now or at the
+ *                                          end of date.
+ *  - movement <number> <from> <to>         Roll-up movement over a period
+ *                                          (both dates inclusive, whole days).
+ *  - details <number> <file>               Writes the account details.
+ *  - tree <file>                           Writes the forest tree.
+ *  - trial | balancesheet | income <file>  Writes a financial report, as CSV
+ *                                          if file ends in ".csv".
+ *  - import <file>                         Imports a CSV/TSV transaction feed,
+ *                                          rejects to "<file>.rejects".
+ *  Dates are "YYYY-MM-DD" or "YYYY-MM-DD HH:MM[:SS]" (UTC).
+ *
+ * Output:
+ *  - A header line "line\tstatus\tmicros\tresult", then for every command
+ *    its input line number, "ok" or "error", its latency in microseconds
+ *    and its result or error message (the rest of the line, which may be
+ *    empty). Messages the tree prints while running a command are captured
+ *    into the result, so nothing else reaches the output stream. A command
+ *    that throws gets an "error" line with the exception's message.
+ *  - The output is flushed whenever no more input is buffered, so a
+ *    process at the other end of a pipe gets each answer straight away
+ *    while a script file is written in large blocks.
+ *
+ * Functions:
+ *  - bool runFile(const string& filename):
+ *      Runs every command in the file, or in standard input for "-".
+ *      Returns false if the file cannot be opened.
+ *  - void run(istream& in):
+ *      Runs commands until the end of in.
+ *  - const ScriptStats& stats() const:
+ *      Returns counters and latencies for the commands run so far.
+ *  - void printStats(ostream& os) const:
+ *      Writes a one-line summary: throughput and latency percentiles.
+ */
+
+#ifndef SCRIPT_RUNNER_H
+#define SCRIPT_RUNNER_H
+
+#include <string>
+#include <string_view>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cstddef>
+#include "ForestTree.h"
+
+using namespace std;
+
+/**
+ * Struct: ScriptStats
+ * Purpose: Counters and timing gathered while running commands.
+ */
+struct ScriptStats {
+    size_t commands = 0;     // Commands run, errors included
+    size_t errors = 0;       // Commands that failed
+    double seconds = 0;      // Wall-clock time spent running commands
+    vector<float> latencies; // Microseconds taken by each command, in order
+
+    double commandsPerSecond() const { return seconds > 0 ? commands / seconds : 0; }
+};
+
+/**
+ * Class: ScriptRunner
+ * Purpose: Non-interactive command interpreter over a ForestTree.
+ */
+class ScriptRunner {
+private:
+    ForestTree& tree;       // Tree the commands act on
+    ostream& out;           // Result lines
+    ostream& log;           // Errors about the script itself
+    ostringstream captured; // What the tree printed during the current command
+    bool headerWritten;     // The result header has been written
+    ScriptStats last;       // Statistics for the commands run so far
+
+    // Runs one command; returns false and sets result on failure
+    bool execute(string_view command, string_view arguments, string& result);
+
+public:
+    explicit ScriptRunner(ForestTree& tree, ostream& out = cout, ostream& log = cerr);
+
+    bool runFile(const string& filename);  // Runs a script file, or stdin for "-"
+    void run(istream& in);                 // Runs commands until the end of in
+
+    const ScriptStats& stats() const { return last; }
+
+    void printStats(ostream& os) const;
+};
+
+#endif
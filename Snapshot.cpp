@@ -0,0 +1,334 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: Snapshot.cpp
+ * Purpose: Implements saving a ForestTree to a binary snapshot and restoring
+ *          it from a memory-mapped file.
+ */
+
+#include "Snapshot.h"
+#include "ForestTree.h"
+#include "MappedFile.h"
+#include "Checksum.h"
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+const char MAGIC[8] = {'C', 'O', 'A', 'S', 'N', 'A', 'P', '\0'};
+
+static_assert(is_trivially_copyable_v<Transaction>, "Postings are stored as raw bytes");
+
+// Rounds an offset up to the next section boundary
+size_t alignUp(size_t offset) {
+    return (offset + Snapshot::ALIGNMENT - 1) & ~(Snapshot::ALIGNMENT - 1);
+}
+
+// Header checksum, computed with the headerCrc field zeroed
+uint32_t headerChecksum(SnapshotHeader header) {
+    header.headerCrc = 0;
+    return crc32(&header, sizeof(header));
+}
+
+/**
+ * Class: BodyWriter
+ * Purpose: Writes body sections through one large stdio buffer while
+ *          keeping a running checksum and the section alignment.
+ */
+class BodyWriter {
+private:
+    FILE* file;
+    uint64_t written;  // Body bytes so far
+    uint32_t crc;      // CRC-32 of the body so far
+    bool failed;
+
+public:
+    explicit BodyWriter(FILE* file) : file(file), written(0), crc(0), failed(false) {}
+
+    void write(const void* data, size_t length) {
+        if (length == 0) {
+            return;
+        }
+        crc = crc32(data, length, crc);
+        failed |= fwrite(data, 1, length, file) != length;
+        written += length;
+    }
+
+    // Pads with zeros so the next section starts aligned
+    void align() {
+        static const char zeros[Snapshot::ALIGNMENT] = {};
+        write(zeros, alignUp(written) - written);
+    }
+
+    template <typename T>
+    void section(const vector<T>& values) {
+        write(values.data(), values.size() * sizeof(T));
+        align();
+    }
+
+    template <typename T>
+    void section(const CowColumn<T>& column) {
+        column.forEachRun([&](size_t, const T* values, size_t count) {
+            write(values, count * sizeof(T));
+        });
+        align();
+    }
+
+    uint64_t size() const { return written; }
+    uint32_t checksum() const { return crc; }
+    bool ok() const { return !failed; }
+};
+
+/**
+ * Class: BodyReader
+ * Purpose: Hands out the sections of a mapped body in order, checking that
+ *          each one fits.
+ */
+class BodyReader {
+private:
+    const char* data;
+    size_t length;
+    size_t offset;
+
+public:
+    BodyReader(const char* data, size_t length) : data(data), length(length), offset(0) {}
+
+    // Returns the next section of count values, or nullptr if it does not fit
+    template <typename T>
+    const T* section(uint64_t count) {
+        if (count > (length - offset) / sizeof(T)) {
+            return nullptr;
+        }
+        const T* values = reinterpret_cast<const T*>(data + offset);
+        offset = min(alignUp(offset + count * sizeof(T)), length);
+        return values;
+    }
+};
+
+// True if starts is a non-decreasing run of n + 1 offsets ending within total
+bool validStarts(const uint64_t* starts, uint64_t n, uint64_t total) {
+    if (starts == nullptr || starts[0] != 0 || starts[n] > total) {
+        return false;
+    }
+    for (uint64_t i = 0; i < n; ++i) {
+        if (starts[i] > starts[i + 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+// Writes every account and posting to filename. The data goes to a
+// temporary file that is synced and renamed over the old snapshot, so a
+// crash during the save leaves the previous snapshot intact.
+bool Snapshot::save(const ForestTree& tree, const string& filename, uint64_t journalOffset) {
+    const AccountArena& store = tree.store;
+    const uint32_t n = store.size();
+
+    // Offset tables and text pools
+    vector<uint32_t> nextSequences(n);
+    vector<uint64_t> numberStarts(n + 1, 0), descriptionStarts(n + 1, 0), postingStarts(n + 1, 0);
+    string numberText, descriptionText;
+    vector<uint32_t> preorder;  // Ids in trie order, so loading builds the trie front to back
+    preorder.reserve(n);
+    tree.accounts.forEachWithPrefix("", [&](Account* account) {
+        preorder.push_back(account->id);
+    });
+    for (uint32_t id = 0; id < n; ++id) {
+        const Account* account = store.at(id);
+        nextSequences[id] = static_cast<uint32_t>(account->slotBySequence.size());
+        numberText.append(account->number);
+        descriptionText.append(account->description());
+        numberStarts[id + 1] = numberText.size();
+        descriptionStarts[id + 1] = descriptionText.size();
+        postingStarts[id + 1] = postingStarts[id] + account->transactions.size();
+    }
+
+    string temporary = filename + ".tmp";
+    FILE* file = fopen(temporary.c_str(), "wb");
+    if (file == nullptr) {
+        cout << "Error: Could not open file \"" << temporary << "\" for writing.\n";
+        return false;
+    }
+    vector<char> ioBuffer(1 << 20);
+    setvbuf(file, ioBuffer.data(), _IOFBF, ioBuffer.size());
+
+    SnapshotHeader header = {};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.repSize = sizeof(Money::Rep);
+    header.accountCount = n;
+    header.postingCount = postingStarts[n];
+    header.journalOffset = journalOffset;
+    fwrite(&header, sizeof(header), 1, file);  // Rewritten once the body checksum is known
+
+    BodyWriter body(file);
+    body.section(store.columns.balances);
+    body.section(nextSequences);
+    body.section(numberStarts);
+    body.section(descriptionStarts);
+    body.section(postingStarts);
+    body.section(preorder);
+    body.write(numberText.data(), numberText.size());
+    body.align();
+    body.write(descriptionText.data(), descriptionText.size());
+    body.align();
+    for (uint32_t id = 0; id < n; ++id) {
+        const vector<Transaction>& records = store.at(id)->transactions;
+        body.write(records.data(), records.size() * sizeof(Transaction));
+    }
+
+    header.bodyBytes = body.size();
+    header.bodyCrc = body.checksum();
+    header.headerCrc = headerChecksum(header);
+
+    bool ok = body.ok() && fseek(file, 0, SEEK_SET) == 0 &&
+              fwrite(&header, sizeof(header), 1, file) == 1 && fflush(file) == 0;
+#ifdef _WIN32
+    ok = ok && _commit(_fileno(file)) == 0;
+#else
+    ok = ok && fsync(fileno(file)) == 0;
+#endif
+    ok = fclose(file) == 0 && ok;
+
+    error_code error;
+    if (ok) {
+        filesystem::rename(temporary, filename, error);
+        ok = !error;
+    }
+    if (!ok) {
+        filesystem::remove(temporary, error);
+        cout << "Error: Could not write snapshot \"" << filename << "\".\n";
+    }
+    return ok;
+}
+
+// Restores a snapshot into an empty tree: the file is mapped, both checksums
+// are verified, and then each section is copied out in bulk
+SnapshotStats Snapshot::load(const string& filename, ForestTree& tree) {
+    SnapshotStats stats;
+    auto start = chrono::steady_clock::now();
+
+    if (tree.size() != 0) {
+        cout << "Error: A snapshot can only be loaded into an empty forest.\n";
+        return stats;
+    }
+
+    MappedFile mapped;
+    if (!mapped.open(filename)) {
+        return stats;  // No snapshot yet
+    }
+    string_view contents = mapped.contents();
+
+    SnapshotHeader header;
+    if (contents.size() < sizeof(header)) {
+        cout << "Error: \"" << filename << "\" is not a snapshot.\n";
+        return stats;
+    }
+    memcpy(&header, contents.data(), sizeof(header));
+    if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.headerCrc != headerChecksum(header)) {
+        cout << "Error: \"" << filename << "\" is not a snapshot.\n";
+        return stats;
+    }
+    if (header.version != VERSION || header.repSize != sizeof(Money::Rep)) {
+        cout << "Error: \"" << filename << "\" was written by an incompatible version.\n";
+        return stats;
+    }
+    const char* bodyData = contents.data() + sizeof(header);
+    if (header.bodyBytes != contents.size() - sizeof(header) ||
+        crc32(bodyData, header.bodyBytes) != header.bodyCrc) {
+        cout << "Error: Snapshot \"" << filename << "\" is damaged.\n";
+        return stats;
+    }
+
+    const uint64_t n = header.accountCount;
+    BodyReader body(bodyData, header.bodyBytes);
+    const Money::Rep* balances = body.section<Money::Rep>(n);
+    const uint32_t* nextSequences = body.section<uint32_t>(n);
+    const uint64_t* numberStarts = body.section<uint64_t>(n + 1);
+    const uint64_t* descriptionStarts = body.section<uint64_t>(n + 1);
+    const uint64_t* postingStarts = body.section<uint64_t>(n + 1);
+    const uint32_t* preorder = body.section<uint32_t>(n);
+    const char* numberText = numberStarts ? body.section<char>(numberStarts[n]) : nullptr;
+    const char* descriptionText = descriptionStarts ? body.section<char>(descriptionStarts[n]) : nullptr;
+    const Transaction* postings = body.section<Transaction>(header.postingCount);
+    if (balances == nullptr || nextSequences == nullptr || preorder == nullptr || numberText == nullptr ||
+        descriptionText == nullptr || postings == nullptr || n >= AccountColumns::NO_PARENT ||
+        !validStarts(numberStarts, n, numberStarts[n]) ||
+        !validStarts(descriptionStarts, n, descriptionStarts[n]) ||
+        !validStarts(postingStarts, n, header.postingCount)) {
+        cout << "Error: Snapshot \"" << filename << "\" is damaged.\n";
+        return stats;
+    }
+
+    // Accounts are recreated in id order, so every id matches the file
+    auto numberOf = [&](uint64_t id) {
+        return string_view(numberText + numberStarts[id], numberStarts[id + 1] - numberStarts[id]);
+    };
+    tree.reserveAccounts(n);
+    for (uint64_t id = 0; id < n; ++id) {
+        string_view description(descriptionText + descriptionStarts[id],
+                                descriptionStarts[id + 1] - descriptionStarts[id]);
+        Account* account = tree.store.create(string(numberOf(id)), description);
+
+        const Transaction* first = postings + postingStarts[id];
+        const Transaction* last = postings + postingStarts[id + 1];
+        account->transactions.assign(first, last);
+        account->slotBySequence.assign(nextSequences[id], Account::NO_SLOT);
+        Money debits, credits;
+        for (uint32_t slot = 0; slot < account->transactions.size(); ++slot) {
+            const Transaction& record = account->transactions[slot];
+            if (record.isDeleted()) {
+                ++account->deletedCount;
+                continue;
+            }
+            if (record.sequence() < nextSequences[id]) {
+                account->slotBySequence[record.sequence()] = slot;
+            }
+            (record.isCredit() ? credits : debits) += record.amount;
+        }
+        tree.store.columns.debitTotals.mutate(id) = debits.minorUnits();
+        tree.store.columns.creditTotals.mutate(id) = credits.minorUnits();
+    }
+    tree.store.columns.balances.assign(balances, n);
+
+    // Index the accounts in trie order, which appends the trie's nodes in
+    // the order the lookups and linkHierarchy() walk them
+    for (uint64_t i = 0; i < n; ++i) {
+        uint32_t id = preorder[i];
+        atomic<Account*>* slot = nullptr;
+        if (id < n && tree.isValidAccountNumber(numberOf(id))) {
+            slot = &tree.accounts.emplace(numberOf(id));
+        }
+        if (slot == nullptr || slot->load(memory_order_relaxed) != nullptr) {
+            cout << "Error: Snapshot \"" << filename << "\" has an invalid or duplicate account.\n";
+            tree.accounts.clear();
+            tree.store.clear();
+            return stats;
+        }
+        slot->store(tree.store.at(id), memory_order_release);
+    }
+    tree.linkHierarchy();  // Parents, children and roll-ups
+
+    stats.loaded = true;
+    stats.accounts = n;
+    stats.postings = header.postingCount;
+    stats.journalOffset = header.journalOffset;
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return stats;
+}
@@ -0,0 +1,90 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: Snapshot.h
+ * Purpose: Defines the Snapshot class, which saves a whole ForestTree
+ *          (accounts, balances and postings) to a versioned, checksummed
+ *          binary file and restores it with a handful of bulk copies.
+ *
+ * File layout (native byte order, every section starts on a 16-byte boundary):
+ *  - SnapshotHeader (64 bytes), with a CRC-32 of itself and of the body.
+ *  - Body, one array per section, indexed by account id:
+ *      Money::Rep balances[n]          Own balance of each account
+ *      uint32 nextSequences[n]         Next transaction sequence number
+ *      uint64 numberStarts[n + 1]      Offsets into the number text
+ *      uint64 descriptionStarts[n + 1] Offsets into the description text
+ *      uint64 postingStarts[n + 1]     Offsets into the posting array
+ *      uint32 preorder[n]              Account ids in hierarchy (trie) order
+ *      char numberText[], char descriptionText[]
+ *      Transaction postings[]          Each account's records, tombstones included
+ *
+ * Postings are stored exactly as they sit in memory, so restoring an account
+ * is one copy of its records; the hierarchy and roll-ups are rebuilt with
+ * one linkHierarchy() pass. Account ids are preserved, so posting IDs stay
+ * valid across a save and load.
+ *
+ * Functions:
+ *  - static bool save(const ForestTree& tree, const string& filename,
+ *                     uint64_t journalOffset):
+ *      Writes the snapshot to a temporary file and renames it over filename.
+ *      journalOffset is the journal position the snapshot already includes.
+ *  - static SnapshotStats load(const string& filename, ForestTree& tree):
+ *      Restores a snapshot into an empty tree. Check stats.loaded.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+using namespace std;
+
+class ForestTree;
+
+/**
+ * Struct: SnapshotHeader
+ * Purpose: Fixed-size file header; describes and checksums the body.
+ */
+struct SnapshotHeader {
+    char magic[8];            // "COASNAP" + '\0'
+    uint32_t version;         // Snapshot::VERSION
+    uint32_t repSize;         // sizeof(Money::Rep) of the writer
+    uint64_t accountCount;    // Number of accounts
+    uint64_t postingCount;    // Number of stored Transaction records
+    uint64_t journalOffset;   // Journal bytes already reflected in the snapshot
+    uint64_t bodyBytes;       // Size of everything after the header
+    uint32_t bodyCrc;         // CRC-32 of the body
+    uint32_t headerCrc;       // CRC-32 of this header with headerCrc = 0
+    uint64_t reserved;        // Zero
+};
+
+/**
+ * Struct: SnapshotStats
+ * Purpose: Outcome of Snapshot::load.
+ */
+struct SnapshotStats {
+    bool loaded = false;          // False if the file is missing or invalid
+    size_t accounts = 0;          // Accounts restored
+    size_t postings = 0;          // Transaction records restored
+    uint64_t journalOffset = 0;   // Where to resume replaying the journal
+    double seconds = 0;           // Wall-clock load time
+};
+
+/**
+ * Class: Snapshot
+ * Purpose: Saves and restores a ForestTree in one binary file.
+ */
+class Snapshot {
+public:
+    static constexpr uint32_t VERSION = 2;  // 2: postings carry a timestamp
+    static constexpr size_t ALIGNMENT = 16;  // Section alignment within the file
+
+    static bool save(const ForestTree& tree, const string& filename, uint64_t journalOffset = 0);
+    static SnapshotStats load(const string& filename, ForestTree& tree);
+};
+
+static_assert(sizeof(SnapshotHeader) == 64, "SnapshotHeader must stay 64 bytes");
+
+#endif
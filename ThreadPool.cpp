@@ -0,0 +1,48 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: ThreadPool.cpp
+ * Purpose: Implements the ThreadPool worker loop, startup and shutdown.
+ */
+
+#include "ThreadPool.h"
+
+// Constructor: Starts the workers
+ThreadPool::ThreadPool(unsigned threads) : stopping(false) {
+    if (threads == 0) {
+        threads = max(1u, thread::hardware_concurrency());
+    }
+    workers.reserve(threads);
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::run, this);
+    }
+}
+
+// Destructor: Lets the workers drain the queue, then joins them
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(tasksMutex);
+        stopping = true;
+    }
+    ready.notify_all();
+    for (thread& worker : workers) {
+        worker.join();
+    }
+}
+
+// Takes tasks in FIFO order until the pool stops and the queue is empty
+void ThreadPool::run() {
+    for (;;) {
+        function<void()> task;
+        {
+            unique_lock<mutex> lock(tasksMutex);
+            ready.wait(lock, [&] { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,77 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: ThreadPool.h
+ * Purpose: Defines the ThreadPool class, a fixed set of worker threads that
+ *          run submitted tasks in FIFO order.
+ *
+ * Fields:
+ *  - vector<thread> workers: The worker threads.
+ *  - deque<function<void()>> tasks: Tasks waiting for a worker.
+ *
+ * Functions:
+ *  - ThreadPool(unsigned threads):
+ *      Starts threads workers (0 means one per hardware thread).
+ *  - future<R> submit(F task):
+ *      Queues task and returns a future for its result. An exception thrown
+ *      by the task is rethrown by future::get().
+ *  - ~ThreadPool():
+ *      Runs every task already queued, then joins the workers.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+
+using namespace std;
+
+/**
+ * Class: ThreadPool
+ * Purpose: Runs independent tasks on a fixed number of threads.
+ */
+class ThreadPool {
+private:
+    vector<thread> workers;
+    deque<function<void()>> tasks;
+    mutex tasksMutex;
+    condition_variable ready;  // Signalled when a task arrives or on shutdown
+    bool stopping;
+
+    void run();  // Worker loop
+
+public:
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    template <typename F>
+    future<invoke_result_t<F>> submit(F task);
+};
+
+// packaged_task is move-only, so it is shared to fit in a function<void()>
+template <typename F>
+future<invoke_result_t<F>> ThreadPool::submit(F task) {
+    auto packaged = make_shared<packaged_task<invoke_result_t<F>()>>(move(task));
+    future<invoke_result_t<F>> result = packaged->get_future();
+    {
+        lock_guard<mutex> lock(tasksMutex);
+        tasks.emplace_back([packaged] { (*packaged)(); });
+    }
+    ready.notify_one();
+    return result;
+}
+
+#endif
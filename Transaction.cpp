@@ -8,15 +8,13 @@
  * Date: 26/11/2024
  */
 #include <algorithm> // Required for all_of
+#include <chrono>
+#include <charconv>
 
 #include "Transaction.h"
 
 // Constructor to initialize transaction details with validation
-Transaction::Transaction(const string& accountNumber, double amount, char debitCredit) {
-    if (!isValidAccountNumber(accountNumber)) {
-        throw invalid_argument("Error: Invalid account number. Must contain only numeric characters.");
-    }
-
+Transaction::Transaction(uint32_t accountId, Money amount, char debitCredit, int64_t timestamp) {
     if (!isValidAmount(amount)) {
         throw invalid_argument("Error: Transaction amount must be non-negative.");
     }
@@ -25,15 +23,17 @@ Transaction::Transaction(const string& accountNumber, double amount, char debitC
         throw invalid_argument("Error: Invalid transaction type. Use 'D' for Debit or 'C' for Credit.");
     }
 
-    this->accountNumber = accountNumber;
     this->amount = amount;
-    this->debitCredit = debitCredit;
+    this->accountId = accountId;
+    this->flags = (debitCredit == 'C' ? CREDIT : 0);
+    this->timestamp = timestamp;
 }
 
 // Overloaded << operator to print transaction details
 ostream& operator<<(ostream& os, const Transaction& t) {
-    os << "Account: " << t.accountNumber << ", Amount: " << t.amount
-       << ", Type: " << (t.debitCredit == 'D' ? "Debit" : "Credit");
+    char date[Transaction::TIME_CHARS];
+    os << "Amount: " << t.amount << ", Type: " << (t.isCredit() ? "Credit" : "Debit") << ", Date: ";
+    os.write(date, Transaction::formatTime(t.timestamp, date) - date);
     return os;
 }
 
@@ -48,6 +48,89 @@ bool Transaction::isValidTransactionType(char debitCredit) {
 }
 
 // Validates transaction amount (must be non-negative)
-bool Transaction::isValidAmount(double amount) {
-    return amount >= 0;
+bool Transaction::isValidAmount(Money amount) {
+    return !amount.isNegative();
+}
+
+// Current wall-clock time in whole seconds
+int64_t Transaction::currentTime() {
+    return chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// Parses a UTC date with an optional time of day. Fields must have their
+// full width ("2024-03-31 09:05"), and out-of-range dates are rejected.
+bool Transaction::parseTime(string_view text, int64_t& time, bool endOfDay) {
+    auto field = [&](size_t offset, size_t width, int& value) {
+        if (offset + width > text.size()) {
+            return false;
+        }
+        const char* first = text.data() + offset;
+        auto [last, error] = from_chars(first, first + width, value);
+        return error == errc() && last == first + width && isdigit(static_cast<unsigned char>(*first));
+    };
+
+    int year, month, day, hours = 0, minutes = 0, seconds = 0;
+    if (!field(0, 4, year) || text.size() < 10 || text[4] != '-' || text[7] != '-' ||
+        !field(5, 2, month) || !field(8, 2, day)) {
+        return false;
+    }
+    chrono::year_month_day date{chrono::year(year), chrono::month(month), chrono::day(day)};
+    if (!date.ok()) {
+        return false;
+    }
+
+    if (text.size() == 10) {
+        if (endOfDay) {
+            hours = 23, minutes = 59, seconds = 59;
+        }
+    } else {
+        if ((text[10] != ' ' && text[10] != 'T') || !field(11, 2, hours) || text.size() < 16 ||
+            text[13] != ':' || !field(14, 2, minutes)) {
+            return false;
+        }
+        if (text.size() != 16 && (text.size() != 19 || text[16] != ':' || !field(17, 2, seconds))) {
+            return false;
+        }
+        if (hours > 23 || minutes > 59 || seconds > 59) {
+            return false;
+        }
+    }
+
+    int64_t days = chrono::sys_days(date).time_since_epoch().count();
+    time = days * 86400 + hours * 3600 + minutes * 60 + seconds;
+    return true;
+}
+
+// Formats a timestamp as "YYYY-MM-DD HH:MM:SS" (UTC)
+char* Transaction::formatTime(int64_t time, char* first) {
+    const int64_t EARLIEST = -62167219200;  // 0000-01-01 00:00:00
+    const int64_t LATEST = 253402300799;    // 9999-12-31 23:59:59
+    if (time < EARLIEST || time > LATEST) {
+        return to_chars(first, first + TIME_CHARS, time).ptr;  // Outside the printable calendar
+    }
+
+    chrono::sys_seconds point{chrono::seconds(time)};
+    chrono::sys_days day = chrono::floor<chrono::days>(point);
+    chrono::year_month_day date(day);
+    int64_t secondOfDay = (point - day).count();
+
+    auto put = [&](int64_t value, int width) {
+        for (int i = width - 1; i >= 0; --i) {
+            first[i] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        }
+        first += width;
+    };
+    put(static_cast<int>(date.year()), 4);
+    *first++ = '-';
+    put(static_cast<unsigned>(date.month()), 2);
+    *first++ = '-';
+    put(static_cast<unsigned>(date.day()), 2);
+    *first++ = ' ';
+    put(secondOfDay / 3600, 2);
+    *first++ = ':';
+    put(secondOfDay / 60 % 60, 2);
+    *first++ = ':';
+    put(secondOfDay % 60, 2);
+    return first;
 }
@@ -3,28 +3,69 @@
  * Advanced Data Structure Project composed of 6 files
  * Current File: Transaction.h
  * Purpose: Defines the Transaction class representing a single transaction
- *          with details such as account number, amount, and transaction type.
+ *          as a packed 24-byte record: account ID, amount, type flag, a
+ *          per-account sequence number that gives it a stable ID, and the
+ *          time it was posted.
  * Authors: Abdallah Al Jawhary, Jad Aintrazy, Omar Mohtar, Khaled Kaed Bey
  * Date: 26/11/2024
  *
  * Fields:
- *  - string accountNumber: The account associated with the transaction.
- *  - double amount: The transaction amount.
- *  - char debitCredit: 'D' for debit, 'C' for credit transaction.
+ *  - Money amount: The transaction amount, exact to the cent.
+ *  - uint32_t accountId: ID of the account that owns the transaction
+ *    (see ForestTree::accountById).
+ *  - uint32_t flags: Bit field. CREDIT marks a credit (otherwise a debit),
+ *    DELETED marks a tombstone, and the upper 30 bits hold the sequence
+ *    number the owning account assigned when the record was appended.
+ *  - int64_t timestamp: When the posting took effect, in seconds since the
+ *    Unix epoch (UTC).
+ *
+ * A posting's stable 64-bit ID is (accountId << 32) | sequence. It never
+ * changes, even when deletions compact the account's transaction vector.
+ *
+ * The record is trivially copyable, so vectors of transactions can be copied
+ * with memcpy, written to disk as-is and scanned without pointer chasing.
  *
  * Functions:
- *  - Transaction(string accountNumber, double amount, char debitCredit):
+ *  - Transaction(uint32_t accountId, Money amount, char debitCredit, int64_t timestamp):
  *      Constructor to initialize the transaction fields.
+ *  - static Transaction unchecked(uint32_t accountId, Money amount, char debitCredit,
+ *                                 int64_t timestamp):
+ *      Builds a record without validation, for callers that validated already.
+ *  - char debitCredit() const:
+ *      Returns 'D' for a debit or 'C' for a credit.
+ *  - uint32_t sequence() const / uint64_t postingId() const:
+ *      The per-account sequence number and the stable posting ID.
  *  - friend ostream& operator<<(ostream& os, const Transaction& t):
  *      Overloaded operator to display transaction details.
+ *  - static int64_t currentTime():
+ *      The current time as a timestamp.
+ *  - static bool parseTime(string_view text, int64_t& time, bool endOfDay):
+ *      Parses "YYYY-MM-DD", "YYYY-MM-DD HH:MM[:SS]" (or with 'T') as UTC. A
+ *      bare date is its first second, or its last one with endOfDay.
+ *  - static char* formatTime(int64_t time, char* first):
+ *      Writes "YYYY-MM-DD HH:MM:SS" into a buffer of at least TIME_CHARS
+ *      bytes and returns one past the last character written.
+ *
+ * Struct Posting: One line of a posting batch, before it is resolved to an
+ * account (see ForestTree::postBatch). A posting without a timestamp
+ * (NO_TIME) is stamped with the time it is posted.
+ *
+ * Struct JournalEntry: A double-entry transaction made of several postings
+ * whose debits equal their credits (see ForestTree::postEntry). Every line
+ * takes the entry's timestamp.
  */
 
 #ifndef TRANSACTION_H
 #define TRANSACTION_H
 
 #include <string>
+#include <string_view>
+#include <span>
 #include <iostream>
+#include <cstdint>
+#include <type_traits>
 #include <stdexcept> // For exception handling
+#include "Money.h"
 
 using namespace std;
 
@@ -34,12 +75,48 @@ using namespace std;
  */
 class Transaction {
 public:
-    string accountNumber;   // Account associated with the transaction
-    double amount;          // Transaction amount
-    char debitCredit;       // 'D' for Debit, 'C' for Credit
+    static constexpr uint32_t CREDIT = 1u << 0;          // Set for credits, clear for debits
+    static constexpr uint32_t DELETED = 1u << 1;         // Set once the posting is deleted
+    static constexpr uint32_t SEQUENCE_SHIFT = 2;        // Sequence lives above the flag bits
+    static constexpr uint32_t MAX_SEQUENCE = (1u << 30) - 1;
+    static constexpr int64_t NO_TIME = INT64_MIN;         // "Stamp with the current time"
+    static constexpr size_t TIME_CHARS = 32;              // Buffer size for formatTime
+
+    Money amount;           // Transaction amount
+    uint32_t accountId;     // Account associated with the transaction
+    uint32_t flags;         // CREDIT, DELETED and the sequence number
+    int64_t timestamp;      // Seconds since the Unix epoch (UTC)
+
+    // Constructors
+    Transaction() = default;
+    Transaction(uint32_t accountId, Money amount, char debitCredit, int64_t timestamp);
 
-    // Constructor
-    Transaction(const string& accountNumber, double amount, char debitCredit);
+    // Builds a record from fields the caller has already validated
+    static Transaction unchecked(uint32_t accountId, Money amount, char debitCredit, int64_t timestamp) {
+        Transaction transaction;
+        transaction.amount = amount;
+        transaction.accountId = accountId;
+        transaction.flags = (debitCredit == 'C' ? CREDIT : 0);
+        transaction.timestamp = timestamp;
+        return transaction;
+    }
+
+    // Transaction type: 'D' for Debit, 'C' for Credit
+    bool isCredit() const { return (flags & CREDIT) != 0; }
+    char debitCredit() const { return isCredit() ? 'C' : 'D'; }
+
+    // Amount with its sign applied: positive for debits, negative for credits
+    Money signedAmount() const { return isCredit() ? -amount : amount; }
+
+    // Tombstone flag; deleted postings stay in place until compaction
+    bool isDeleted() const { return (flags & DELETED) != 0; }
+
+    // Sequence number within the owning account, and the stable posting ID
+    uint32_t sequence() const { return flags >> SEQUENCE_SHIFT; }
+    void setSequence(uint32_t sequence) {
+        flags = (flags & (CREDIT | DELETED)) | (sequence << SEQUENCE_SHIFT);
+    }
+    uint64_t postingId() const { return (static_cast<uint64_t>(accountId) << 32) | sequence(); }
 
     // Overloaded << operator to print transaction details
     friend ostream& operator<<(ostream& os, const Transaction& t);
@@ -51,7 +128,42 @@ public:
     static bool isValidTransactionType(char debitCredit);
 
     // Validates transaction amount (must be non-negative)
-    static bool isValidAmount(double amount);
+    static bool isValidAmount(Money amount);
+
+    // Timestamps: the clock, and UTC dates in and out
+    static int64_t currentTime();
+    static bool parseTime(string_view text, int64_t& time, bool endOfDay = false);
+    static char* formatTime(int64_t time, char* first);
 };
 
+/**
+ * Struct: Posting
+ * Purpose: One requested posting, addressed by account number, as submitted
+ *          to ForestTree::postBatch. The number is only viewed, not copied.
+ */
+struct Posting {
+    string_view accountNumber;  // Account to post to
+    Money amount;               // Non-negative amount
+    char debitCredit;           // 'D' for Debit, 'C' for Credit
+    int64_t timestamp = Transaction::NO_TIME;  // When it took effect; NO_TIME for now
+};
+
+/**
+ * Struct: JournalEntry
+ * Purpose: One balanced journal entry, posted all at once or not at all.
+ *          The lines are only viewed, so a large run can keep all of its
+ *          lines in one vector and point each entry at a slice of it.
+ */
+struct JournalEntry {
+    static constexpr size_t MAX_LINES = UINT16_MAX;  // Lines one journal record can hold
+
+    span<const Posting> lines;                 // At least two; their own timestamps are ignored
+    int64_t timestamp = Transaction::NO_TIME;  // When the entry took effect; NO_TIME for now
+};
+
+static_assert(is_trivially_copyable<Transaction>::value, "Transaction must stay memcpy-able");
+#ifndef COA_MONEY_128
+static_assert(sizeof(Transaction) == 24, "Transaction should pack into 24 bytes");
+#endif
+
 #endif
@@ -0,0 +1,305 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: TransactionImporter.cpp
+ * Purpose: Implements the TransactionImporter class. The feed is read with
+ *          fread into one reused buffer, each complete line is split into
+ *          string_view fields in place, and the parsed postings are handed
+ *          to ForestTree::postBatch before the buffer is refilled.
+ */
+
+#include "TransactionImporter.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+
+namespace {
+
+// Returns true for the whitespace characters trimmed from fields
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Removes leading and trailing blanks without copying
+string_view trim(string_view text) {
+    size_t begin = 0;
+    size_t end = text.size();
+    while (begin < end && isBlank(text[begin])) ++begin;
+    while (end > begin && isBlank(text[end - 1])) --end;
+    return text.substr(begin, end - begin);
+}
+
+// Compares ASCII text with a lower-case word, ignoring case
+bool equalsIgnoreCase(string_view text, string_view word) {
+    return text.size() == word.size() && equal(text.begin(), text.end(), word.begin(), [](char a, char b) {
+        return (a >= 'A' && a <= 'Z' ? a - 'A' + 'a' : a) == b;
+    });
+}
+
+// Maps D, C, Debit or Credit (any case) to 'D' or 'C', or returns 0
+char parseType(string_view text) {
+    if (text.size() == 1) {
+        char type = text[0] >= 'a' && text[0] <= 'z' ? text[0] - 'a' + 'A' : text[0];
+        return type == 'D' || type == 'C' ? type : 0;
+    }
+    if (equalsIgnoreCase(text, "debit")) {
+        return 'D';
+    }
+    if (equalsIgnoreCase(text, "credit")) {
+        return 'C';
+    }
+    return 0;
+}
+
+} // namespace
+
+// Constructor: Binds the importer to a tree; delimiter detected per file
+TransactionImporter::TransactionImporter(ForestTree& tree, ostream& log, size_t bufferBytes)
+    : tree(tree), log(log), bufferBytes(max(bufferBytes, MIN_BUFFER_BYTES)), delimiter(0),
+      fixedDelimiter(0), rejects(nullptr), lineNumber(0), firstRow(true) {}
+
+// Reads the file one buffer at a time. Only complete lines are parsed; the
+// partial line at the end of a buffer is moved to the front and finished by
+// the next read, after the batch that points into the buffer is posted.
+bool TransactionImporter::importFile(const string& filename, const string& rejectFilename) {
+    FILE* file = fopen(filename.c_str(), "rb");
+    if (!file) {
+        log << "Error: Could not open file " << filename << endl;
+        return false;
+    }
+
+    ofstream rejectFile;
+    if (!rejectFilename.empty()) {
+        rejectFile.open(rejectFilename);
+        if (!rejectFile.is_open()) {
+            log << "Error: Could not open file \"" << rejectFilename << "\" for writing.\n";
+            fclose(file);
+            return false;
+        }
+        rejectFile << "line\treason\trow\n";
+    }
+
+    auto start = chrono::steady_clock::now();
+    last = ImportStats();
+    last.bufferBytes = bufferBytes;
+    rejects = rejectFile.is_open() ? &rejectFile : nullptr;
+    delimiter = fixedDelimiter;
+    lineNumber = 0;
+    firstRow = true;
+    batch.clear();
+    rows.clear();
+    batch.reserve(MAX_BATCH_ROWS);
+    rows.reserve(MAX_BATCH_ROWS);
+
+    vector<char> buffer(bufferBytes);
+    size_t filled = 0;      // Bytes in buffer, the carried-over partial line first
+    bool skipping = false;  // Discarding the rest of a line longer than the buffer
+    bool atEnd = false;
+    while (!atEnd) {
+        size_t got = fread(buffer.data() + filled, 1, buffer.size() - filled, file);
+        filled += got;
+        last.bytes += got;
+        atEnd = got == 0;
+
+        const char* cursor = buffer.data();
+        const char* end = cursor + filled;
+        while (cursor < end) {
+            const char* newline = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+            if (!newline) {
+                if (!atEnd) {
+                    break;  // Finished after the next read
+                }
+                newline = end;  // Last line without a terminator
+            }
+            if (skipping) {
+                skipping = false;
+            } else {
+                handleLine(string_view(cursor, newline - cursor));
+            }
+            cursor = newline + 1;
+        }
+        size_t consumed = min<size_t>(cursor - buffer.data(), filled);
+
+        if (consumed == 0 && filled == buffer.size()) {
+            // A whole buffer without a newline: reject the line and drop the
+            // rest of it as it arrives
+            if (!skipping) {
+                ++lineNumber;
+                ++last.rows;
+                reject(lineNumber, "Row is longer than the read buffer.", string_view(buffer.data(), 64));
+                skipping = true;
+            }
+            consumed = filled;
+        }
+
+        // Postings point into the buffer, so post them before it moves
+        flush();
+        memmove(buffer.data(), buffer.data() + consumed, filled - consumed);
+        filled -= consumed;
+    }
+
+    bool readError = ferror(file) != 0;
+    fclose(file);
+    rejects = nullptr;
+    last.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (readError) {
+        log << "Error: Could not read file " << filename << endl;
+        return false;
+    }
+    return true;
+}
+
+// Skips blank lines and the header, then parses and queues the row
+void TransactionImporter::handleLine(string_view line) {
+    ++lineNumber;
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    if (trim(line).empty()) {
+        return;
+    }
+
+    if (firstRow) {
+        firstRow = false;
+        if (delimiter == 0) {
+            delimiter = line.find('\t') != string_view::npos ? '\t' : ',';
+        }
+        string_view fields[MAX_FIELDS];
+        size_t count = 0;
+        if (!splitRow(line, fields, count) && !tree.isValidAccountNumber(fields[0])) {
+            last.header = true;
+            return;
+        }
+    }
+
+    ++last.rows;
+    Posting posting;
+    if (const char* problem = parseRow(line, posting)) {
+        reject(lineNumber, problem, line);
+        return;
+    }
+    batch.push_back(posting);
+    rows.push_back({line, lineNumber});
+    if (batch.size() == MAX_BATCH_ROWS) {
+        flush();
+    }
+}
+
+// Splits on the delimiter, honouring double quotes. Quoted fields are
+// returned without their quotes; a "" inside one is left as it is, which
+// only a reference can contain.
+const char* TransactionImporter::splitRow(string_view row, string_view* fields, size_t& count) const {
+    count = 0;
+    size_t i = 0;
+    while (true) {
+        if (count == MAX_FIELDS) {
+            return "Too many fields.";
+        }
+        while (i < row.size() && row[i] == ' ') ++i;
+
+        if (i < row.size() && row[i] == '"') {
+            size_t begin = ++i;
+            size_t quote;
+            while ((quote = row.find('"', i)) != string_view::npos &&
+                   quote + 1 < row.size() && row[quote + 1] == '"') {
+                i = quote + 2;  // Escaped quote
+            }
+            if (quote == string_view::npos) {
+                return "Unterminated quote.";
+            }
+            fields[count++] = row.substr(begin, quote - begin);
+            for (i = quote + 1; i < row.size() && isBlank(row[i]) && row[i] != delimiter; ++i) {}
+            if (i < row.size() && row[i] != delimiter) {
+                return "Text after a closing quote.";
+            }
+        } else {
+            size_t end = min(row.find(delimiter, i), row.size());
+            fields[count++] = trim(row.substr(i, end - i));
+            i = end;
+        }
+
+        if (i >= row.size()) {
+            return nullptr;
+        }
+        ++i;  // Past the delimiter
+    }
+}
+
+// Parses account, amount, type and the optional date; the reference is
+// only split off
+const char* TransactionImporter::parseRow(string_view row, Posting& posting) const {
+    string_view fields[MAX_FIELDS];
+    size_t count = 0;
+    if (const char* problem = splitRow(row, fields, count)) {
+        return problem;
+    }
+    if (count < 3) {
+        return "Too few fields.";
+    }
+
+    if (!tree.isValidAccountNumber(fields[0])) {
+        return "Invalid account number.";
+    }
+    posting.accountNumber = fields[0];
+
+    if (!Money::parse(fields[1], posting.amount)) {
+        return "Invalid amount.";
+    }
+    if (posting.amount.isNegative()) {
+        return "Negative amount.";
+    }
+
+    posting.debitCredit = parseType(fields[2]);
+    if (posting.debitCredit == 0) {
+        return "Invalid transaction type.";
+    }
+
+    posting.timestamp = Transaction::NO_TIME;
+    if (count > 3 && !fields[3].empty() && !Transaction::parseTime(fields[3], posting.timestamp, false)) {
+        return "Invalid date.";
+    }
+    return nullptr;
+}
+
+// Rows reach here fully parsed, so postBatch only refuses unknown accounts
+// and amounts that would overflow a balance
+void TransactionImporter::flush() {
+    if (batch.empty()) {
+        return;
+    }
+    PostingBatchResult result = tree.postBatch(batch);
+    last.posted += result.posted;
+    ++last.batches;
+    size_t nextOutOfRange = 0;  // Both lists are in index order
+    for (size_t index : result.rejected) {
+        bool outOfRange = nextOutOfRange < result.outOfRange.size() && result.outOfRange[nextOutOfRange] == index;
+        nextOutOfRange += outOfRange;
+        reject(rows[index].line, outOfRange ? "Amount is out of range." : "Account not found.", rows[index].text);
+    }
+    batch.clear();
+    rows.clear();
+}
+
+// Counts the row and, if there is a reject file, writes it there
+void TransactionImporter::reject(size_t line, const char* reason, string_view row) {
+    ++last.rejected;
+    if (rejects) {
+        *rejects << line << '\t' << reason << '\t' << row << '\n';
+    }
+}
+
+// Writes a one-line summary of the last import, including throughput
+void TransactionImporter::printStats(ostream& os) const {
+    os << "Imported " << last.posted << " postings from " << last.rows << " rows";
+    if (last.rejected > 0) {
+        os << " (" << last.rejected << " rejected)";
+    }
+    os << " in " << last.seconds * 1000.0 << " ms: "
+       << static_cast<size_t>(last.rowsPerSecond()) << " rows/s, "
+       << last.bytesPerSecond() / (1024.0 * 1024.0) << " MB/s, "
+       << last.batches << " batches through a " << last.bufferBytes / 1024 << " KB buffer\n";
+}
@@ -0,0 +1,132 @@
+/**
+ * Course: CSIS217 Section 71
+ * Advanced Data Structure Project composed of multiple files
+ * Current File: TransactionImporter.h
+ * Purpose: Defines the TransactionImporter class, which streams a CSV or TSV
+ *          transaction feed through a fixed-size buffer and posts its rows
+ *          to a ForestTree in batches.
+ *
+ * File format:
+ *  - One posting per row: "account,amount,D/C[,date[,reference]]", with
+ *    commas or tabs between fields (detected from the first row unless set).
+ *  - The amount has at most two decimals. The type is D, C, Debit or
+ *    Credit in any case. The date is "YYYY-MM-DD" or "YYYY-MM-DD HH:MM[:SS]"
+ *    (UTC); rows without one are stamped with the time they are posted.
+ *    The reference is checked for shape only: postings do not store one.
+ *  - Fields may be wrapped in double quotes, with "" for a quote inside.
+ *  - A first row whose account is not numeric is taken as a header.
+ *  - Blank rows are skipped; rows may end in "\n" or "\r\n".
+ *
+ * Memory:
+ *  - The file is read in bufferBytes pieces and never held whole. Parsed
+ *    postings point into the buffer, so each batch (at most MAX_BATCH_ROWS
+ *    rows) is posted before the buffer is refilled. Apart from the postings
+ *    added to the tree, memory stays at the buffer plus one batch however
+ *    large the feed is. A row longer than the buffer is rejected.
+ *
+ * Rejects:
+ *  - Rows that do not parse, or that postBatch refuses (e.g. an unknown
+ *    account), are counted and, if a reject file was given, written to it as
+ *    "<line>\t<reason>\t<row>" so they can be fixed and imported again.
+ *
+ * Functions:
+ *  - bool importFile(const string& filename, const string& rejectFilename = ""):
+ *      Imports every row. Returns false if a file cannot be opened or read.
+ *  - void setDelimiter(char delimiter):
+ *      Field separator; 0 (the default) detects a tab or a comma.
+ *  - const ImportStats& stats() const:
+ *      Returns counters and timing for the most recent import.
+ *  - void printStats(ostream& os) const:
+ *      Writes a one-line summary of the last import, including throughput.
+ */
+
+#ifndef TRANSACTION_IMPORTER_H
+#define TRANSACTION_IMPORTER_H
+
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <iostream>
+#include <vector>
+#include <cstddef>
+#include "ForestTree.h"
+
+using namespace std;
+
+/**
+ * Struct: ImportStats
+ * Purpose: Counters and timing gathered while importing a transaction feed.
+ */
+struct ImportStats {
+    size_t rows = 0;         // Non-blank rows seen, not counting a header
+    size_t posted = 0;       // Postings added to the tree
+    size_t rejected = 0;     // Rows that were not posted
+    size_t bytes = 0;        // Input size in bytes
+    size_t batches = 0;      // Calls to ForestTree::postBatch
+    size_t bufferBytes = 0;  // Size of the read buffer
+    bool header = false;     // The first row was a header
+    double seconds = 0;      // Wall-clock time spent reading, parsing and posting
+
+    double rowsPerSecond() const { return seconds > 0 ? rows / seconds : 0; }
+    double bytesPerSecond() const { return seconds > 0 ? bytes / seconds : 0; }
+};
+
+/**
+ * Class: TransactionImporter
+ * Purpose: Streams delimited transaction rows into ForestTree::postBatch.
+ */
+class TransactionImporter {
+public:
+    static constexpr size_t DEFAULT_BUFFER_BYTES = 1 << 20;  // Read size
+    static constexpr size_t MIN_BUFFER_BYTES = 4 << 10;      // Smallest buffer accepted
+    static constexpr size_t MAX_BATCH_ROWS = 16384;          // Postings per postBatch call
+    static constexpr size_t MAX_FIELDS = 5;                  // account, amount, type, date, reference
+
+private:
+    // Where a parsed posting came from, for the reject file
+    struct ImportRow {
+        string_view text;
+        size_t line;
+    };
+
+    ForestTree& tree;         // Destination tree
+    ostream& log;             // Destination for errors
+    size_t bufferBytes;       // Read buffer size
+    char delimiter;           // Field separator; 0 until detected
+    char fixedDelimiter;      // Separator set by the caller, or 0 to detect
+    ostream* rejects;         // Reject file, or nullptr to only count
+    size_t lineNumber;        // Lines read so far, blank ones included
+    bool firstRow;            // No non-blank row seen yet
+    vector<Posting> batch;    // Postings waiting for postBatch
+    vector<ImportRow> rows;   // Source of each posting in batch
+    ImportStats last;         // Statistics for the most recent import
+
+    // Splits a row into unquoted fields; returns why it cannot be, or nullptr
+    const char* splitRow(string_view row, string_view* fields, size_t& count) const;
+
+    // Parses one row into a posting; returns why it cannot be, or nullptr
+    const char* parseRow(string_view row, Posting& posting) const;
+
+    // Handles one line (without its "\n"): skips, rejects or queues it
+    void handleLine(string_view line);
+
+    // Posts the queued batch and rejects the rows postBatch refused
+    void flush();
+
+    // Counts a rejected row and writes it to the reject file
+    void reject(size_t line, const char* reason, string_view row);
+
+public:
+    explicit TransactionImporter(ForestTree& tree, ostream& log = cout,
+                                 size_t bufferBytes = DEFAULT_BUFFER_BYTES);
+
+    void setDelimiter(char delimiter) { fixedDelimiter = delimiter; }
+
+    bool importFile(const string& filename, const string& rejectFilename = "");
+
+    const ImportStats& stats() const { return last; }
+
+    void printStats(ostream& os) const;
+};
+
+#endif
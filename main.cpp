@@ -16,14 +16,45 @@
  *
  * Functions:
  *  - void displayMenu(): Displays the user menu for forest tree management.
- *  - void loadAccountsFromFile(ForestTree& tree, const string& filename): Loads
- *      accounts from a file and adds them to the forest tree.
- *  - int main(): The main entry point for the program.
+ *  - void loadAccountsFromFile(ForestTree& tree, const string& filename, bool verbose, ostream& os):
+ *      Bulk-loads accounts from a file through ChartLoader and prints throughput.
+ *  - void openJournal(ForestTree& tree, Journal& journal, const string& filename,
+ *                     Durability durability, uint64_t from, ostream& os):
+ *      Replays an existing journal (from offset from) into the tree, then
+ *      journals every change.
+ *  - void importTransactions(ForestTree& tree, const string& filename, ostream& os):
+ *      Streams a CSV/TSV transaction feed into the tree through
+ *      TransactionImporter, writing bad rows to "<filename>.rejects".
+ *  - bool loadSnapshot(ForestTree& tree, const string& filename, uint64_t& journalOffset, ostream& os):
+ *      Restores the tree from a binary snapshot instead of the text chart.
+ *  - void saveSnapshot(ForestTree& tree, const string& filename, Journal& journal, ostream& os):
+ *      Saves the tree to a snapshot on exit, if one was requested.
+ *  The loading functions report progress to os: cout, or cerr in script mode.
+ *  - int main(int argc, char* argv[]): The main entry point for the program.
+ *      Pass "-v" to echo every line of the chart while it loads,
+ *      "--journal <file>" to make changes durable, and
+ *      "--durability none|async|sync" to choose how often it is synced, and
+ *      "--snapshot <file>" to start from (and save on exit) a binary snapshot,
+ *      "--import <file>" to post a transaction feed before the menu opens, and
+ *      "--script <file>" to run the commands in file ("-" for standard input)
+ *      through ScriptRunner instead of showing the menu. Script mode writes
+ *      only result lines to standard output and everything else, including
+ *      a latency summary, to standard error, so it can sit in a pipeline.
+ *      "--serve <socket>" keeps the tree resident and serves LedgerServer's
+ *      binary protocol on a Unix socket until SIGINT or SIGTERM (Linux).
+ *      A snapshot records how much of the journal it covers, so pass the same
+ *      "--journal" with every run that uses the snapshot.
  */
 
 #include <iostream>
 #include <fstream>
 #include "ForestTree.h"
+#include "ChartLoader.h"
+#include "Journal.h"
+#include "Snapshot.h"
+#include "TransactionImporter.h"
+#include "ScriptRunner.h"
+#include "LedgerServer.h"
 #include <limits> 
 
 using namespace std;
@@ -38,70 +69,154 @@ void displayMenu() {
     cout << "5. Print Account Details\n";
     cout << "6. Print Forest Tree\n";
     cout << "7. Exit\n";
+    cout << "8. Balance As Of Date\n";
+    cout << "9. Import Transactions From File\n";
     cout << "Choose an option: ";
 }
 
 // Function to load accounts from a file
-void loadAccountsFromFile(ForestTree& tree, const string& filename) {
-    ifstream file(filename);
-    if (!file.is_open()) {
-        cout << "Error: Could not open file " << filename << endl;
-        return;
+void loadAccountsFromFile(ForestTree& tree, const string& filename, bool verbose, ostream& os) {
+    ChartLoader loader(tree, os);
+    loader.setVerbose(verbose);
+    if (loader.loadFile(filename)) {
+        loader.printStats(os);
     }
+}
 
-    cout << "Loading accounts from file: " << filename << endl;
-
-    string line;
-    while (getline(file, line)) {
-        // Remove leading and trailing whitespace
-        line.erase(0, line.find_first_not_of(" \t"));
-        line.erase(line.find_last_not_of(" \t") + 1);
-
-        if (line.empty()) continue; // Skip empty lines
-
-        // Parse the line into account number and description
-        size_t spaceIndex = line.find(' ');
-        if (spaceIndex != string::npos) {
-            string number = line.substr(0, spaceIndex);  // Account number
-            string description = line.substr(spaceIndex + 1);  // Description
-
-            // Trim the number and description to ensure no leading/trailing whitespace
-            number.erase(0, number.find_first_not_of(" \t"));
-            number.erase(number.find_last_not_of(" \t") + 1);
-            description.erase(0, description.find_first_not_of(" \t"));
-            description.erase(description.find_last_not_of(" \t") + 1);
-
-            // Debugging output: show what's being read
-            cout  << line << " -> Account number: " << number << ", Description: " << description << endl;
-
-            // Ensure the account number is valid (numeric) using tree's method
-            if (tree.isValidAccountNumber(number)) {
-                // Attempt to add the account to the tree
-                if (tree.searchAccount(number) == nullptr) {
-                    tree.addAccount(number, description);
-                } else {
-                    cout << "Duplicate account found: " << number << " - Skipping." << endl;
-                }
-            } else {
-                // Skip invalid account numbers and log the error
-                cout << "Invalid account number found: " << number << " - Skipping." << endl;
-            }
-        } else {
-            // Log invalid line format and skip
-            cout << "Invalid line format: " << line << endl;
+// Function to import a transaction feed, keeping bad rows for correction
+void importTransactions(ForestTree& tree, const string& filename, ostream& os) {
+    TransactionImporter importer(tree, os);
+    string rejectFilename = filename + ".rejects";
+    if (importer.importFile(filename, rejectFilename)) {
+        importer.printStats(os);
+        if (importer.stats().rejected > 0) {
+            os << "Rejected rows were written to \"" << rejectFilename << "\".\n";
         }
     }
+}
 
-    file.close();
+// Function to restore the forest from a snapshot, if one exists
+bool loadSnapshot(ForestTree& tree, const string& filename, uint64_t& journalOffset, ostream& os) {
+    SnapshotStats stats = Snapshot::load(filename, tree);
+    if (stats.loaded) {
+        os << "Loaded snapshot: " << stats.accounts << " accounts, " << stats.postings
+             << " postings in " << stats.seconds << " s.\n";
+        journalOffset = stats.journalOffset;
+    }
+    return stats.loaded;
+}
+
+// Function to recover from and then attach a journal
+void openJournal(ForestTree& tree, Journal& journal, const string& filename, Durability durability,
+                 uint64_t from, ostream& os) {
+    JournalReplayStats stats = from ? Journal::replay(filename, tree, from) : Journal::replay(filename, tree);
+    if (stats.validBytes > 0) {
+        os << "Replayed journal: " << stats.accounts << " accounts, " << stats.postings
+             << " postings, " << stats.deletions << " deletions";
+        if (stats.skipped > 0) {
+            os << ", " << stats.skipped << " skipped";
+        }
+        os << " in " << stats.seconds << " s.\n";
+        if (stats.tornTail) {
+            os << "Warning: The journal ended in an incomplete record, which was discarded.\n";
+        }
+    }
+    if (journal.open(filename, durability)) {
+        tree.attachJournal(&journal);
+    }
+}
+
+// Function to save the forest, noting how much of the journal it covers
+void saveSnapshot(ForestTree& tree, const string& filename, Journal& journal, ostream& os) {
+    if (!filename.empty() && Snapshot::save(tree, filename, journal.position())) {
+        os << "Snapshot saved to \"" << filename << "\".\n";
+    }
 }
 
 // Main function
-int main() {
+int main(int argc, char* argv[]) {
     ForestTree forestTree; // Initialize the forest tree
     int choice;            // User menu choice
 
-    // Automatically load accounts from the file when the program starts
-    loadAccountsFromFile(forestTree, "accountswithspace.txt");
+    // "-v" or "--verbose" echoes every line of the chart while loading
+    bool verbose = false;
+    string journalFile;                          // "--journal <file>"
+    string snapshotFile;                         // "--snapshot <file>"
+    string importFile;                           // "--import <file>"
+    string scriptFile;                           // "--script <file>" or "--script -"
+    string socketPath;                           // "--serve <socket>"
+    Durability durability = Durability::AsyncGroupCommit;  // "--durability none|async|sync"
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-v" || arg == "--verbose") {
+            verbose = true;
+        } else if (arg == "--journal" && i + 1 < argc) {
+            journalFile = argv[++i];
+        } else if (arg == "--snapshot" && i + 1 < argc) {
+            snapshotFile = argv[++i];
+        } else if (arg == "--import" && i + 1 < argc) {
+            importFile = argv[++i];
+        } else if (arg == "--script" && i + 1 < argc) {
+            scriptFile = argv[++i];
+        } else if (arg == "--serve" && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (arg == "--durability" && i + 1 < argc) {
+            string mode = argv[++i];
+            if (mode == "none") {
+                durability = Durability::None;
+            } else if (mode == "sync") {
+                durability = Durability::EveryRecord;
+            } else if (mode == "async") {
+                durability = Durability::AsyncGroupCommit;
+            } else {
+                cerr << "Error: Unknown durability \"" << mode << "\". Use none, async or sync.\n";
+            }
+        }
+    }
+
+    // Script mode keeps standard output for result lines only
+    ostream& status = scriptFile.empty() ? cout : cerr;
+
+    // Start from the snapshot if there is one, else load the text chart
+    uint64_t journalOffset = 0;
+    if (snapshotFile.empty() || !loadSnapshot(forestTree, snapshotFile, journalOffset, status)) {
+        loadAccountsFromFile(forestTree, "accountswithspace.txt", verbose, status);
+    }
+
+    // Recover changes made since the snapshot, then log new ones
+    Journal journal;
+    if (!journalFile.empty()) {
+        openJournal(forestTree, journal, journalFile, durability, journalOffset, status);
+    }
+
+    // Imported postings are journaled like any others
+    if (!importFile.empty()) {
+        importTransactions(forestTree, importFile, status);
+    }
+
+    // Run the script instead of the menu. Nothing has used stdio directly,
+    // so the streams can drop stdio syncing, and untying cin lets results
+    // be flushed in blocks rather than before every read.
+    if (!scriptFile.empty()) {
+        ios::sync_with_stdio(false);
+        cin.tie(nullptr);
+        ScriptRunner runner(forestTree, cout, cerr);
+        bool ran = runner.runFile(scriptFile);
+        runner.printStats(cerr);
+        saveSnapshot(forestTree, snapshotFile, journal, cerr);
+        return ran ? 0 : 1;
+    }
+
+    // Serve local clients until stopped, then save as on exit
+    if (!socketPath.empty()) {
+        LedgerServer server(forestTree, cout);
+        bool served = server.run(socketPath);
+        if (served) {
+            server.printStats(cout);
+        }
+        saveSnapshot(forestTree, snapshotFile, journal, cout);
+        return served ? 0 : 1;
+    }
 
     do {
         displayMenu(); // Display menu
@@ -122,7 +237,7 @@ int main() {
         case 2: {
     // Add Transaction
     string accountNumber;
-    double amount;
+    Money amount;
     char type;
 
     // Validate account number (must exist)
@@ -140,18 +255,17 @@ int main() {
         }
     }
 
-    // Validate transaction amount (must be non-negative)
+    // Validate transaction amount (must be non-negative, at most two decimals)
     bool validAmount = false;
     while (!validAmount) {
+        string amountText;
         cout << "Enter transaction amount: ";
-        cin >> amount;
+        cin >> amountText;
         
         // Check if the amount is valid (non-negative)
-        if (cin.fail()) {
-            cout << "Error: Invalid input. Please enter a valid transaction amount (numeric).\n";
-            cin.clear();  // Clear the error state
-            cin.ignore(numeric_limits<streamsize>::max(), '\n');  // Ignore invalid input in the buffer
-        } else if (amount >= 0) {
+        if (!Money::parse(amountText, amount)) {
+            cout << "Error: Invalid input. Please enter a valid transaction amount (e.g. 125.50).\n";
+        } else if (!amount.isNegative()) {
             validAmount = true;  // Valid amount
         } else {
             cout << "Error: Transaction amount must be non-negative.\n";
@@ -188,12 +302,12 @@ int main() {
         case 3: {
             // Delete Transaction
             string accountNumber;
-            int index;
+            int id;
             cout << "Enter account number: ";
             cin >> accountNumber;
-            cout << "Enter transaction index to delete: ";
-            cin >> index;
-            forestTree.deleteTransaction(accountNumber, index);
+            cout << "Enter transaction ID to delete: ";
+            cin >> id;
+            forestTree.deleteTransaction(accountNumber, id);
             break;
         }
         case 4: {
@@ -203,7 +317,7 @@ int main() {
             cin >> number;
             Account* account = forestTree.searchAccount(number);
             if (account) {
-                cout << "Account found: " << account->number << " - " << account->description << "\n";
+                cout << "Account found: " << account->number << " - " << account->description() << "\n";
             } else {
                 cout << "Account not found.\n";
             }
@@ -233,10 +347,38 @@ int main() {
             // Exit
             cout << "Exiting...\n";
             break;
+        case 8: {
+            // Balance of an account and its sub-accounts at the end of a date
+            string number, dateText;
+            int64_t time;
+            cout << "Enter account number: ";
+            cin >> number;
+            cout << "Enter date (YYYY-MM-DD or YYYY-MM-DD HH:MM:SS, UTC): ";
+            cin.ignore();
+            getline(cin, dateText);
+            Money balance;
+            if (!Transaction::parseTime(dateText, time, true)) {
+                cout << "Error: Invalid date.\n";
+            } else if (forestTree.balanceAsOf(number, time, balance)) {
+                cout << "Balance of " << number << " as of " << dateText << ": $" << balance << "\n";
+            }
+            break;
+        }
+        case 9: {
+            // Import Transactions From File
+            string filename;
+            cout << "Enter CSV or TSV filename (account,amount,D/C[,date[,reference]]): ";
+            cin.ignore();
+            getline(cin, filename);
+            importTransactions(forestTree, filename, cout);
+            break;
+        }
         default:
             cout << "Invalid choice. Please try again.\n";
         }
     } while (choice != 7);
 
+    // Save everything, noting how much of the journal the snapshot covers
+    saveSnapshot(forestTree, snapshotFile, journal, cout);
     return 0;
 }